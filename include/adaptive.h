@@ -0,0 +1,42 @@
+#ifndef ADAPTIVE_H
+#define ADAPTIVE_H
+
+#include <stdio.h>
+#include "image.h"
+
+// Throughput-adaptive output: keeps an estimate of how many bytes per second the
+// terminal (or the link in front of it) actually absorbs, and lowers the output
+// settings until a frame fits the time budget. The quality ladder goes, one step
+// at a time: color tolerance 8 then 16 (TrueColor), 256 colors, 16 colors, then
+// fewer columns (x0.75 per step, down to ADAPTIVE_MIN_COLUMNS).
+
+#define ADAPTIVE_MIN_COLUMNS 20
+
+typedef struct {
+    double target_seconds;  // Time budget per frame / image
+    double throughput;      // Bytes per second, 0 = not measured yet
+    size_t n_samples;
+} adaptive_t;
+
+void adaptive_init(adaptive_t* adaptive, double target_ms);
+
+// Measures the terminal on `in_fd` / `out_fd` (both must be terminals): times a
+// cursor position query, alone and behind an invisible payload, so the result
+// reflects what the terminal has actually processed, not what sits in buffers.
+// Returns 0 on success, -1 if the terminal did not answer.
+int adaptive_probe_terminal(adaptive_t* adaptive, int in_fd, int out_fd);
+
+// Adds a measurement: `bytes` written in `seconds` of blocking writes.
+// Writes too small to have filled any buffer are ignored.
+void adaptive_observe(adaptive_t* adaptive, size_t bytes, double seconds);
+
+// Largest frame that fits the budget, 0 if the throughput is still unknown
+size_t adaptive_budget(const adaptive_t* adaptive);
+
+// Lowers `options` by one step of the ladder. Returns 0 if already at the bottom.
+int adaptive_degrade(export_options_t* options);
+
+// One line on `out`: chosen settings, expected frame time and throughput
+void adaptive_report(const adaptive_t* adaptive, const export_options_t* options, size_t frame_bytes, FILE* out);
+
+#endif
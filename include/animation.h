@@ -0,0 +1,25 @@
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include "image.h"
+
+// Converted frames of an animation, kept for playback: every frame goes through
+// process_image_to_grid once, so looping never recomputes anything.
+typedef struct {
+    size_t n_frames;
+    ascii_grid_t* grids;    // Heap grids, one per frame
+    int* delays_ms;         // Display time of each frame (never below ANIMATION_MIN_DELAY_MS)
+} frame_cache_t;
+
+// Browsers show GIF frames with tiny or missing delays for 100 ms: do the same
+#define ANIMATION_MIN_DELAY_MS 20
+#define ANIMATION_DEFAULT_DELAY_MS 100
+
+// Converts every frame of `animation` with `options`, frames in parallel on the
+// thread pool. `options` is updated with the render cell size, as
+// process_image_to_grid does. Returns 0 on success, -1 on failure.
+int frame_cache_build(frame_cache_t* cache, const animation_t* animation, export_options_t* options);
+
+void frame_cache_free(frame_cache_t* cache);
+
+#endif
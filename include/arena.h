@@ -0,0 +1,45 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+// Bump allocator for per-conversion temporaries.
+// Everything allocated from an arena is released at once by arena_reset(); after
+// the first conversion the arena keeps a single block big enough for the whole
+// working set, so repeated conversions of the same size never touch the heap.
+
+#define ARENA_ALIGNMENT 64 // Cache line / widest vector register
+
+typedef struct arena_block {
+    struct arena_block* next;
+    size_t size;
+    size_t used;
+    unsigned char* data;
+} arena_block_t;
+
+typedef struct {
+    arena_block_t* blocks;  // Current block first
+    size_t block_size;      // Minimum size of a new block
+
+    // Statistics
+    size_t n_allocs;        // Allocations served since the last reset
+    size_t bytes_used;      // Bytes served since the last reset
+    size_t peak_bytes;      // Largest working set seen across resets
+    size_t n_heap_allocs;   // Blocks requested from the heap over the arena lifetime
+    size_t n_resets;
+} arena_t;
+
+void arena_init(arena_t* arena, size_t block_size);
+
+// Returns ARENA_ALIGNMENT-aligned memory, or NULL if the heap is exhausted
+void* arena_alloc(arena_t* arena, size_t size);
+void* arena_calloc(arena_t* arena, size_t count, size_t size);
+
+// Releases all allocations. Keeps (and coalesces) the memory for the next round.
+void arena_reset(arena_t* arena);
+void arena_free(arena_t* arena);
+
+void arena_print_stats(const arena_t* arena, FILE* out);
+
+#endif
@@ -5,8 +5,26 @@
 
 struct arguments {
     char *filename;
+    char **filenames; // Tutti i file posizionali (filenames[0] == filename), da liberare
+    int n_files;
+    double delay; // Secondi tra un'immagine e l'altra nello slideshow
+    int loops; // Ripetizioni delle GIF animate e dei video ASCII (0 = infinite)
+    int video_width, video_height; // Dimensioni dei frame RGB24 grezzi su stdin (0 = Y4M)
+    double fps; // Frame al secondo per il video da stdin o ASCII (0 = dall'header, altrimenti 30)
+    char *transcode_path; // Se impostato, converte il video in un file ASCII video (da liberare)
+    int window; // Frame in lavorazione contemporaneamente durante la conversione (0 = automatico)
+    char *grid_path; // Se impostato, salva la griglia convertita in formato binario (da liberare)
+    int grid_rle; // Comprime i piani della griglia salvata (RLE)
+    double adaptive_ms; // Se > 0, tempo massimo per frame: colonne e colori si adattano al terminale
     // Opzioni legacy/core
     int width; // Larghezza in caratteri (se 0, calcola in base a terminale o opzioni)
+    int threads; // Thread del pool condiviso (0 = uno per CPU)
+    int print_cpu_info; // Stampa il percorso SIMD selezionato
+    int watch; // Resta attivo e riconverte il file a ogni modifica (inotify)
+    int interactive; // Visualizzatore interattivo con zoom e spostamento
+    int has_crop; // Converte solo la regione --crop della sorgente
+    double crop[4]; // x, y, larghezza, altezza della regione
+    int crop_percent[4]; // Se 1, il valore corrispondente è una percentuale della sorgente
     
     // Tutte le opzioni di export e configurazione avanzata
     export_options_t options;
@@ -14,4 +32,7 @@ struct arguments {
 
 struct arguments parse_args(int argc, char *argv[]);
 
+// Dimensioni del terminale in caratteri; restituisce 0 se non è un terminale
+int try_get_terminal_size(int* width, int* height);
+
 #endif
@@ -0,0 +1,83 @@
+#ifndef ASCIIVIDEO_H
+#define ASCIIVIDEO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "image.h"
+
+// --- ASCII Video Files ---
+// A sequence of converted grids with a frame rate, for playback without
+// reprocessing the source. Every few frames a keyframe stores a whole grid;
+// the frames in between only store the runs of cells that changed since the
+// previous frame. Layout (integers little-endian, varints LEB128):
+//   header:   "ASCIIVID", u32 version, u32 fps numerator, u32 fps denominator,
+//             u32 keyframe interval
+//   record:   u8 type ('K' keyframe, 'D' delta), u32 payload size, payload
+//   keyframe: u32 width, u32 height, u32 flags (ASCIIVIDEO_GLYPHS, ASCIIVIDEO_BACKGROUND),
+//             then per plane a varint size and the PackBits-coded plane
+//   delta:    varint run count, per run a varint gap (cells since the end of the
+//             previous run) and a varint length, then per plane a varint size and
+//             the PackBits-coded values of the run cells, back to back
+// Planes are chars, r, g, b, the four bytes of each glyph (lowest first) and
+// bg_r, bg_g, bg_b when flagged. Runs never cross a row.
+
+#define ASCIIVIDEO_MAGIC "ASCIIVID"
+#define ASCIIVIDEO_VERSION 2
+
+#define ASCIIVIDEO_GLYPHS 0x1
+#define ASCIIVIDEO_BACKGROUND 0x2
+
+// Frames between keyframes when the writer is given 0
+#define ASCIIVIDEO_KEYFRAME_INTERVAL 60
+
+// --- Writing ---
+
+typedef struct asciivideo_writer asciivideo_writer_t;
+
+// Creates the file and writes the header. A keyframe is written every
+// `keyframe_interval` frames (0 = ASCIIVIDEO_KEYFRAME_INTERVAL) and whenever the
+// grid layout changes. Returns NULL on error (reported on stderr).
+asciivideo_writer_t* asciivideo_writer_open(const char* path, uint32_t fps_num, uint32_t fps_den,
+                                            uint32_t keyframe_interval);
+
+// Appends a frame. Returns 0 on success, -1 on write or allocation error.
+int asciivideo_write_frame(asciivideo_writer_t* writer, const ascii_grid_t* grid);
+
+// Closes the file. Returns 0 if every write succeeded, -1 otherwise.
+int asciivideo_writer_close(asciivideo_writer_t* writer);
+
+// --- Reading ---
+// The reader keeps one decoded grid and buffers sized by it, whatever the
+// length of the file.
+
+typedef struct asciivideo_reader asciivideo_reader_t;
+
+typedef struct {
+    const ascii_grid_t* grid;   // Whole current frame (owned by the reader)
+    const grid_span_t* spans;   // Cells that differ from the previous frame
+    size_t n_spans;
+    int clear;                  // The screen must be cleared first (first frame, new layout, seek)
+    int keyframe;
+} asciivideo_frame_t;
+
+// Whether `path` starts with the ASCII video magic
+int asciivideo_probe(const char* path);
+
+// Opens a file and reads its header. Returns NULL on error (reported on stderr).
+asciivideo_reader_t* asciivideo_reader_open(const char* path);
+
+// Frame rate stored in the header
+double asciivideo_reader_fps(const asciivideo_reader_t* reader);
+
+// Decodes the next frame into `frame`, valid until the next call.
+// Returns 0 on success, 1 at the end of the file, -1 on error (reported on stderr).
+int asciivideo_read_frame(asciivideo_reader_t* reader, asciivideo_frame_t* frame);
+
+// Positions the reader so that the next frame read is frame `index` (0-based):
+// skips record headers to the last keyframe before it, then decodes forward.
+// The next frame reports clear. Returns 0 on success, -1 past the end or on error.
+int asciivideo_reader_seek(asciivideo_reader_t* reader, uint64_t index);
+
+void asciivideo_reader_close(asciivideo_reader_t* reader);
+
+#endif
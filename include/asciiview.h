@@ -0,0 +1,90 @@
+#ifndef ASCIIVIEW_H
+#define ASCIIVIEW_H
+
+#include <stdio.h>
+#include "image.h"
+
+// --- libasciiview: embeddable converter ---
+// A context owns every buffer a conversion needs (arena, palette tables, input
+// staging, export font and surface). Converting images of unchanged dimensions
+// reuses them without touching the heap.
+//
+// All calls on a context are serialized by its own lock, so a context may be
+// shared between threads; use one context per thread to convert in parallel.
+// The grid returned by a convert call stays valid until the next convert call
+// on the same context (or its destruction) and must not be freed by the caller.
+
+typedef struct asciiview_ctx asciiview_ctx_t;
+
+// Sets the size of the process-wide thread pool shared by all contexts
+// (0 = one thread per CPU). Only effective before the first conversion.
+void asciiview_set_threads(int n_threads);
+
+asciiview_ctx_t* asciiview_create(void);
+void asciiview_destroy(asciiview_ctx_t* ctx);
+
+// Converts an image with channel values in [0., 1.]. Returns an empty grid on failure.
+// `options` is updated with the render cell size, as process_image_to_grid does.
+ascii_grid_t asciiview_convert(asciiview_ctx_t* ctx, image_t* pixels, export_options_t* options);
+
+// Same as asciiview_convert, for interleaved 8-bit pixels (1 to 4 channels). Returns an
+// empty grid if width * height * channels is zero or too large to stage.
+ascii_grid_t asciiview_convert_rgb8(asciiview_ctx_t* ctx, const uint8_t* pixels, size_t width,
+                                    size_t height, size_t channels, export_options_t* options);
+
+// Incremental mode for sequences of frames (video, slideshows): each conversion
+// compares the frame with the previous one and recomputes only the cells whose
+// source pixels changed (and their edge neighbours). The grid is the same as a full
+// conversion would give; the frame is copied into the context to compare the next one.
+void asciiview_set_incremental(asciiview_ctx_t* ctx, int enabled);
+
+// Writes the last converted grid to the terminal / to options->output_path.
+// Pass the same options used for the conversion. Export returns 0 on success, -1 on failure.
+void asciiview_print(asciiview_ctx_t* ctx, const export_options_t* options);
+int asciiview_export(asciiview_ctx_t* ctx, export_options_t* options);
+// Same for a grid converted elsewhere (e.g. loaded from a grid file); for export,
+// options->cell_pixel_width/height must hold the cell size of its conversion
+void asciiview_print_grid(asciiview_ctx_t* ctx, ascii_grid_t* grid, const export_options_t* options);
+int asciiview_export_grid(asciiview_ctx_t* ctx, ascii_grid_t* grid, export_options_t* options);
+
+// Prints `pixels` as Sixel graphics covering the same terminal area as the last
+// converted grid (its size in cells times options->cell_pixel_width/height).
+// Uses options->palette_size colors if set, 256 otherwise. Returns 0 on success, -1 on failure.
+int asciiview_print_sixel(asciiview_ctx_t* ctx, image_t* pixels, const export_options_t* options);
+
+// With n_buffers >= 2, print and redraw calls only format the frame and queue it:
+// a dedicated thread writes it while the caller converts the next one. When all
+// n_buffers frames are waiting the calls block (backpressure). 0 turns it off,
+// after writing everything queued. Returns 0 on success, -1 on failure.
+int asciiview_set_async_output(asciiview_ctx_t* ctx, size_t n_buffers);
+
+// Waits until every queued frame is written (call before printing anything else
+// to stdout). Returns 0 if all writes succeeded, -1 otherwise.
+int asciiview_flush_output(asciiview_ctx_t* ctx);
+
+// Draws the last converted grid at the top-left of the screen, sending only the
+// cells that changed since the previous redraw on this context (the first call
+// clears the screen). Meant for slideshows and live previews.
+void asciiview_redraw(asciiview_ctx_t* ctx, const export_options_t* options);
+// Same for a grid converted elsewhere (e.g. a cached animation frame)
+void asciiview_redraw_grid(asciiview_ctx_t* ctx, ascii_grid_t* grid, const export_options_t* options);
+
+// Sends only `spans` of `grid` (see render_image_spans), clearing the screen first
+// if `clear`. For grids whose changes are already known, e.g. decoded video deltas;
+// the next asciiview_redraw then sends a full frame.
+void asciiview_draw_spans(asciiview_ctx_t* ctx, const ascii_grid_t* grid, const grid_span_t* spans, size_t n_spans,
+                          int clear, const export_options_t* options);
+
+// Bytes the next asciiview_print (redraw = 0) or asciiview_redraw (redraw = 1)
+// of the last converted grid would send, without sending them
+size_t asciiview_frame_size(asciiview_ctx_t* ctx, const export_options_t* options, int redraw);
+
+// Bytes written to the terminal so far and the time spent blocked writing them
+void asciiview_output_totals(asciiview_ctx_t* ctx, size_t* bytes, double* seconds);
+
+void asciiview_print_stats(asciiview_ctx_t* ctx, FILE* out);
+
+// Name of the SIMD kernel path selected for this CPU ("avx512f", "avx2", "sse2", "generic")
+const char* asciiview_cpu_path(void);
+
+#endif
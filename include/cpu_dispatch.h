@@ -0,0 +1,20 @@
+#ifndef CPU_DISPATCH_H
+#define CPU_DISPATCH_H
+
+// Function multiversioning for the hot kernels.
+// On x86-64 GCC/Clang builds every HOT_KERNEL function is compiled once per
+// instruction set below; the loader picks the best clone for the running CPU
+// (ifunc), so one portable binary uses AVX-512 or AVX2 where available and
+// SSE2 elsewhere. Define ASCIIVIEW_NO_DISPATCH to build a single version.
+#if defined(__x86_64__) && defined(__linux__) && defined(__GNUC__) && !defined(ASCIIVIEW_NO_DISPATCH)
+#define HOT_KERNEL __attribute__((target_clones("default", "avx2", "avx512f")))
+#define HAVE_CPU_DISPATCH 1
+#else
+#define HOT_KERNEL
+#define HAVE_CPU_DISPATCH 0
+#endif
+
+// Name of the kernel path selected for this CPU: "avx512f", "avx2", "sse2" or "generic"
+const char* cpu_dispatch_path(void);
+
+#endif
@@ -3,6 +3,17 @@
 
 #include "image.h"
 
+// Font description, Cairo surface and Pango layout reused across exports.
+// Rebuilt only when the font, the cell height or the output size changes.
+typedef struct export_state export_state_t;
+
+export_state_t* export_state_create(void);
+void export_state_free(export_state_t* state);
+
+// Export the ASCII grid to an image file using (and updating) a reusable state.
+// Returns 0 on success, -1 on failure.
+int export_ascii_with_state(export_state_t* state, ascii_grid_t* grid, export_options_t* options);
+
 // Export the ASCII grid to an image file (PNG/JPG) based on options
 void export_ascii_to_image(ascii_grid_t* grid, export_options_t* options);
 
@@ -0,0 +1,48 @@
+#ifndef GRIDFILE_H
+#define GRIDFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "image.h"
+
+// --- Grid Files ---
+// A converted grid saved as-is, so one processing pass can feed any number of
+// terminal renderings and exports (other color modes, fonts, sizes) later.
+// Layout (integers little-endian):
+//   header (64 bytes): "ASCIIGRD", u32 version, u32 byte order mark 0x01020304,
+//                      u32 flags, u32 width, u32 height, u32 cell pixel width,
+//                      u32 cell pixel height, u32 number of planes, zero padding
+//   plane table: per plane u64 offset, u64 stored size
+//   planes, each at a GRIDFILE_ALIGNMENT-aligned offset, in the order
+//   chars, r, g, b, [glyphs (u32 per cell)], [bg_r, bg_g, bg_b]
+// Uncompressed files are mapped and used in place: the grid planes point into the
+// mapping. With GRIDFILE_RLE each plane is PackBits-encoded and decoded on open.
+
+#define GRIDFILE_MAGIC "ASCIIGRD"
+#define GRIDFILE_VERSION 1
+#define GRIDFILE_ALIGNMENT 64
+
+#define GRIDFILE_GLYPHS 0x1
+#define GRIDFILE_BACKGROUND 0x2
+#define GRIDFILE_RLE 0x4
+
+typedef struct {
+    ascii_grid_t grid;          // Must not be passed to free_ascii_grid
+    int cell_pixel_width;       // Render cell size of the conversion
+    int cell_pixel_height;
+    void* map;                  // Mapping of an uncompressed file, NULL otherwise
+    size_t map_size;
+} grid_file_t;
+
+// Writes `grid` with the cell size of `options`. Returns 0 on success, -1 on failure.
+int gridfile_write(const char* path, const ascii_grid_t* grid, const export_options_t* options, int use_rle);
+
+// Whether the file starts with the grid file magic
+int gridfile_probe(const char* path);
+
+// Maps (or decodes) a grid file. The planes may be modified: changes stay private
+// to the process. Returns 0 on success, -1 on failure (reported on stderr).
+int gridfile_open(grid_file_t* file, const char* path);
+void gridfile_close(grid_file_t* file);
+
+#endif
@@ -2,6 +2,7 @@
 #define MY_IMAGE_LIB
 #include <stdlib.h>
 #include <stdint.h>
+#include "arena.h"
 
 // --- Image Data Structure ---
 typedef struct {
@@ -11,20 +12,88 @@ typedef struct {
     double* data;
 } image_t;
 
-// --- ASCII Grid Structures ---
-typedef struct {
-    char character;
-    uint8_t r;
-    uint8_t g;
-    uint8_t b;
-} ascii_cell_t;
-
+// --- ASCII Grid Structure ---
+// Structure of arrays: each field of a cell lives in its own plane of
+// width * height entries (row-major), so stages can sweep one field at a time.
+// All planes share a single allocation that starts at `chars`.
+// Half-block and braille grids also carry a Unicode glyph per cell (`chars` then
+// holds an ASCII approximation) and, for half blocks, a background color; these
+// optional planes share a second allocation that starts at `glyphs`.
 typedef struct {
     size_t width;   // Number of columns (characters)
     size_t height;  // Number of rows (lines)
-    ascii_cell_t* cells; // 1D array of size width * height
+    char* chars;    // Character plane
+    uint8_t* r;     // Color planes (foreground)
+    uint8_t* g;
+    uint8_t* b;
+    uint32_t* glyphs;   // Unicode code point plane, NULL for plain ASCII grids
+    uint8_t* bg_r;      // Background color planes, NULL if the terminal background is kept
+    uint8_t* bg_g;
+    uint8_t* bg_b;
 } ascii_grid_t;
 
+// Cells [start, start + length) of one grid row (indices into the planes)
+typedef struct {
+    size_t start;
+    size_t length;
+} grid_span_t;
+
+// Rectangle of an image, in pixels
+typedef struct {
+    size_t x, y;
+    size_t width, height;
+} image_region_t;
+
+// Encodes a code point as UTF-8 into `out` (at least 4 bytes); returns the length
+static inline size_t glyph_to_utf8(uint32_t codepoint, char* out) {
+    if (codepoint < 0x80) {
+        out[0] = (char) codepoint;
+        return 1;
+    }
+    if (codepoint < 0x800) {
+        out[0] = (char) (0xC0 | (codepoint >> 6));
+        out[1] = (char) (0x80 | (codepoint & 0x3F));
+        return 2;
+    }
+    if (codepoint < 0x10000) {
+        out[0] = (char) (0xE0 | (codepoint >> 12));
+        out[1] = (char) (0x80 | ((codepoint >> 6) & 0x3F));
+        out[2] = (char) (0x80 | (codepoint & 0x3F));
+        return 3;
+    }
+    out[0] = (char) (0xF0 | (codepoint >> 18));
+    out[1] = (char) (0x80 | ((codepoint >> 12) & 0x3F));
+    out[2] = (char) (0x80 | ((codepoint >> 6) & 0x3F));
+    out[3] = (char) (0x80 | (codepoint & 0x3F));
+    return 4;
+}
+
+// --- Terminal Color Modes ---
+typedef enum {
+    COLOR_MODE_TRUE = 0,    // 24-bit "38;2;r;g;b"
+    COLOR_MODE_256,         // xterm-256 "38;5;n"
+    COLOR_MODE_16,          // ANSI-16 "3n" / "9n"
+    COLOR_MODE_NONE         // Characters only
+} color_mode_t;
+
+// --- Animation Structure ---
+// Frames as decoded (8-bit, interleaved channels), converted to doubles only when processed
+typedef struct {
+    size_t width;
+    size_t height;
+    size_t channels;
+    size_t n_frames;
+    uint8_t* pixels;    // n_frames consecutive frames of width * height * channels bytes
+    int* delays_ms;     // Display time of each frame
+} animation_t;
+
+// --- Glyph Modes ---
+typedef enum {
+    GLYPH_MODE_ASCII = 0,   // One sample per cell, value/edge characters
+    GLYPH_MODE_HALF,        // Upper half block: 1x2 samples per cell (foreground + background)
+    GLYPH_MODE_BRAILLE      // Braille patterns: 2x4 dithered dots per cell
+} glyph_mode_t;
+
 // --- Export Options ---
 typedef struct {
     int export_image;       // 1 = Yes, 0 = No
@@ -40,7 +109,19 @@ typedef struct {
     int scale_factor;       // If > 0, scale factor (1 char per N pixels)
     
     // Processing options
+    glyph_mode_t glyph_mode;
     int use_retro_colors;   // 1 = Retro 3-bit colors, 0 = Truecolor
+    int palette_size;       // If > 0, adaptive palette of N colors computed per image
+    int disable_edges;      // 1 = Skip Sobel edge detection (value characters only)
+    image_region_t crop;    // If crop.width > 0, only this region of the source is converted
+
+    // Terminal output options
+    color_mode_t color_mode;
+    double color_tolerance; // If > 0, merge color runs closer than this (perceptual distance, 0-255 scale)
+    int sixel_preview;      // 1 = Also print a Sixel graphics preview after the text
+
+    // Diagnostics
+    int print_stats;        // 1 = Report allocation counts on stderr
     
     // Calculated render dimensions (used by export.c)
     int cell_pixel_width;
@@ -51,12 +132,39 @@ typedef struct {
 // --- Function Prototypes ---
 
 image_t load_image(const char* file_path);
+// Loads only `region` of the image (clamped to it; NULL = whole image). Binary 8-bit
+// PGM/PPM files are read row by row, skipping everything outside the region; other
+// formats are decoded whole, and only the region is converted and kept.
+image_t load_image_region(const char* file_path, const image_region_t* region);
+// Reads the dimensions of an image file without decoding it. Returns 0 on success, -1 on failure.
+int image_size(const char* file_path, size_t* width, size_t* height);
 void free_image(image_t* image);
+// Loads every frame of an animated GIF. Returns an animation without frames on failure.
+animation_t load_animation(const char* file_path);
+void free_animation(animation_t* animation);
 void free_ascii_grid(ascii_grid_t* grid);
 
-image_t make_resized(image_t* original, size_t max_width, size_t max_height, double character_ratio);
+// Allocates all planes of a width x height grid (from `arena` if not NULL).
+// Returns 0 on success, -1 on allocation failure.
+int alloc_ascii_grid(ascii_grid_t* grid, size_t width, size_t height, arena_t* arena);
+// Adds the glyph plane, and the background planes if `with_background`, to an allocated grid
+int alloc_grid_glyphs(ascii_grid_t* grid, int with_background, arena_t* arena);
+// Copies `src` into the heap-allocated grid `dst` (zeroed or previously copied into),
+// reusing its storage when the dimensions and planes match. Returns 0 on success, -1 on failure.
+int copy_ascii_grid(ascii_grid_t* dst, const ascii_grid_t* src);
 
-image_t make_grayscale(image_t* original);
+// If `arena` is not NULL the pixel data is taken from it and must not be passed to free_image
+image_t make_resized(image_t* original, size_t max_width, size_t max_height, double character_ratio, arena_t* arena);
+// Box-averages `original` down to exactly width x height pixels (neither larger than the original's)
+image_t make_downsampled(image_t* original, size_t width, size_t height, arena_t* arena);
+// Same for a `region` of `original` (the whole image if NULL): only its pixels are read,
+// so the cost follows the region's area, not the image's
+image_t make_resized_region(image_t* original, const image_region_t* region, size_t max_width, size_t max_height,
+                            double character_ratio, arena_t* arena);
+image_t make_downsampled_region(image_t* original, const image_region_t* region, size_t width, size_t height,
+                                arena_t* arena);
+
+image_t make_grayscale(image_t* original, arena_t* arena);
 
 double* get_pixel(image_t* image, size_t x, size_t y);
 void set_pixel(image_t* image, size_t x, size_t y, const double* new_pixel);
@@ -64,4 +172,12 @@ void set_pixel(image_t* image, size_t x, size_t y, const double* new_pixel);
 void get_convolution(image_t* image, double* kernel, double* out);
 void get_sobel(image_t* image, double* out_x, double* out_y);
 
+// Incremental variants: only the pixels whose `mask` entry (one per output pixel)
+// is non-zero are recomputed, the others are left untouched.
+// `resized` must come from make_resized_region on an image of the size of `original`,
+// with the same region (NULL = whole image).
+void update_resized(image_t* original, const image_region_t* region, image_t* resized, const uint8_t* mask);
+void update_grayscale(image_t* original, image_t* grayscale, const uint8_t* mask);
+void update_sobel(image_t* image, double* out_x, double* out_y, const uint8_t* mask);
+
 #endif
\ No newline at end of file
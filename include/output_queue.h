@@ -0,0 +1,37 @@
+#ifndef OUTPUT_QUEUE_H
+#define OUTPUT_QUEUE_H
+
+#include <stddef.h>
+#include "term_writer.h"
+
+// Asynchronous terminal output: a dedicated thread writes finished frames while
+// the caller formats the next one. Frames are written in submission order.
+// The queue owns a fixed set of frame buffers (two or more); when all of them are
+// queued or being written, output_queue_acquire() blocks until the writer thread
+// frees one, so a slow terminal or pipe throttles the producer instead of letting
+// memory grow.
+typedef struct output_queue output_queue_t;
+
+// Starts the writer thread for `fd` with `n_buffers` frame buffers (at least 2).
+// Returns NULL on failure.
+output_queue_t* output_queue_create(int fd, size_t n_buffers);
+
+// Waits for every queued frame to be written, then stops the thread
+void output_queue_destroy(output_queue_t* queue);
+
+// Returns an empty buffer to format the next frame into (blocks while none is free)
+term_writer_t* output_queue_acquire(output_queue_t* queue);
+
+// Queues a buffer obtained from output_queue_acquire() for writing
+void output_queue_submit(output_queue_t* queue, term_writer_t* buffer);
+
+// Waits until every submitted frame has been written.
+// Returns 0 if all writes succeeded since the last call, -1 otherwise.
+int output_queue_drain(output_queue_t* queue);
+
+size_t output_queue_bytes_written(output_queue_t* queue);
+double output_queue_write_seconds(output_queue_t* queue);
+// Number of times the producer had to wait for a free buffer
+size_t output_queue_stalls(output_queue_t* queue);
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef PACKBITS_H
+#define PACKBITS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// PackBits run-length coding, used by the grid and ASCII video files.
+// Control byte n < 128: n + 1 literal bytes follow; n >= 128: the next byte
+// repeats n - 125 times (3 to 130).
+
+// Largest encoded size for `length` input bytes
+size_t packbits_bound(size_t length);
+
+// Encodes `length` bytes into `out` (at least packbits_bound(length) bytes); returns the encoded size
+size_t packbits_encode(const uint8_t* in, size_t length, uint8_t* out);
+
+// Decodes `size` bytes into exactly `length` bytes. Returns 0 on success, -1 on malformed input.
+int packbits_decode(const uint8_t* in, size_t size, uint8_t* out, size_t length);
+
+#endif
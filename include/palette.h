@@ -0,0 +1,43 @@
+#ifndef PALETTE_H
+#define PALETTE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "arena.h"
+
+#define PALETTE_MAX_COLORS 256
+
+// Colors are looked up through a 3D table indexed by the top 5 bits of each channel
+#define COLOR_LUT_BITS 5
+#define COLOR_LUT_SIZE (1 << (3 * COLOR_LUT_BITS))
+#define COLOR_LUT_KEY(r, g, b) \
+    ((((size_t)(r) >> (8 - COLOR_LUT_BITS)) << (2 * COLOR_LUT_BITS)) | \
+     (((size_t)(g) >> (8 - COLOR_LUT_BITS)) << COLOR_LUT_BITS) | \
+     ((size_t)(b) >> (8 - COLOR_LUT_BITS)))
+
+typedef struct {
+    size_t n_colors;
+    uint8_t colors[PALETTE_MAX_COLORS][3];
+    uint8_t* lut; // COLOR_LUT_SIZE entries: quantized RGB -> palette index
+} palette_t;
+
+// Builds an adaptive palette of at most `max_colors` entries (median cut) from
+// `n_pixels` colors, then fills the lookup table. Channel i of pixel k is read
+// from r/g/b[k * stride], so both packed cells and separate planes work.
+// If `arena` is not NULL the histogram and the lookup table are taken from it
+// (do not call free_palette then). Returns 0 on success, -1 on allocation failure.
+int palette_build(palette_t* palette, const uint8_t* r, const uint8_t* g, const uint8_t* b,
+                  size_t n_pixels, size_t stride, size_t max_colors, arena_t* arena);
+
+// Fills palette->lut with the nearest palette entry for every quantized color.
+// Useful for fixed palettes whose colors were set by hand.
+int palette_build_lut(palette_t* palette, arena_t* arena);
+
+void free_palette(palette_t* palette);
+
+// Returns the palette index nearest to the given color (O(1) table lookup)
+static inline uint8_t palette_lookup(const palette_t* palette, uint8_t r, uint8_t g, uint8_t b) {
+    return palette->lut[COLOR_LUT_KEY(r, g, b)];
+}
+
+#endif
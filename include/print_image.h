@@ -2,7 +2,32 @@
 #define PRINT_IMAGE_H
 
 #include "image.h"
+#include "term_writer.h"
 
-void print_image(ascii_grid_t* grid);
+// Formats the whole grid as ANSI text into `out` (not flushed), using the escapes
+// of options->color_mode (TrueColor if `options` is NULL). In the indexed modes
+// colors are mapped through a precomputed lookup table.
+// A color escape is only emitted when the color changes along a line; in TrueColor
+// mode, with options->color_tolerance > 0, colors closer than that to the current
+// run reuse it. Half-block and braille grids are written as UTF-8 glyphs, with a
+// background color escape when the grid has one. Returns 0 on success, -1 on allocation failure.
+int render_image(ascii_grid_t* grid, const export_options_t* options, term_writer_t* out);
+
+// Redraws `grid` at the top-left of the screen over `previous` (the last grid drawn
+// there), sending only the changed cells: a cursor move per span of changes, with
+// short unchanged gaps merged into the span. A NULL `previous`, or one with other
+// dimensions, clears the screen and sends every cell. The frame is wrapped in
+// synchronized-output markers. Returns 0 on success, -1 on allocation failure.
+int render_image_diff(ascii_grid_t* grid, const ascii_grid_t* previous, const export_options_t* options,
+                      term_writer_t* out);
+
+// Sends only the given spans of `grid` (each within one row), after clearing the
+// screen if `clear`: the cost is proportional to the cells sent, not to the grid.
+// For callers that already know what changed, e.g. decoded video deltas.
+// Returns 0 on success, -1 on allocation failure.
+int render_image_spans(const ascii_grid_t* grid, const grid_span_t* spans, size_t n_spans, int clear,
+                       const export_options_t* options, term_writer_t* out);
+
+void print_image(ascii_grid_t* grid, const export_options_t* options);
 
 #endif
@@ -6,6 +6,42 @@
 // Converts an image into an ASCII Grid based on given options.
 // Handles resizing, character selection, and color calculation.
 // The input image 'original' is not modified, but a resized version is created internally.
-ascii_grid_t process_image_to_grid(image_t* original, export_options_t* options);
+// If 'arena' is not NULL all temporaries and the grid cells are allocated from it:
+// the grid then stays valid until the next arena_reset() and must not be passed to free_ascii_grid.
+ascii_grid_t process_image_to_grid(image_t* original, export_options_t* options, arena_t* arena);
+
+// --- Incremental Conversion ---
+// Consecutive frames of a video or slideshow mostly repeat each other. The source
+// is split in DIRTY_TILE_SIZE x DIRTY_TILE_SIZE pixel tiles and the caller flags
+// the tiles that changed since the previous frame (row-major, one byte per tile,
+// ceil(width / DIRTY_TILE_SIZE) tiles per row). Only the cells whose source block
+// touches a flagged tile, and their Sobel neighbours, are recomputed; the others
+// keep their value from the previous frame. The grid is the same that
+// process_image_to_grid would return.
+#define DIRTY_TILE_SIZE 16
+
+// State carried from one frame to the next (heap allocated). Zero-initialize it.
+typedef struct {
+    int valid;
+    size_t src_width, src_height, src_channels;
+    export_options_t key;       // Options the state was built with
+    image_t resized;            // Stages of the previous frame
+    image_t grayscale;
+    double* sobel_x;
+    double* sobel_y;
+    ascii_grid_t grid;
+    uint8_t* pixel_mask;        // Resized pixels recomputed for the current frame
+    uint8_t* cell_mask;         // Cells recomputed for the current frame
+    size_t cells_recomputed;    // Totals over every frame, for statistics
+    size_t cells_total;
+} frame_history_t;
+
+// Converts the next frame. `dirty_tiles` NULL means everything changed; a change of
+// size or options recomputes the whole frame too. The grid belongs to `history` and
+// stays valid until the next call. Returns an empty grid on failure.
+ascii_grid_t process_image_incremental(image_t* original, const uint8_t* dirty_tiles,
+                                       export_options_t* options, frame_history_t* history);
+
+void frame_history_free(frame_history_t* history);
 
 #endif
@@ -0,0 +1,41 @@
+#ifndef PYRAMID_H
+#define PYRAMID_H
+
+#include <stddef.h>
+#include <pthread.h>
+#include "image.h"
+
+// Mip pyramid for navigating large images: level 0 is the image itself and each
+// level halves the previous one (box average, as make_resized). The levels are
+// built by a background thread, coarsest last; views can be served from the
+// levels already built while it runs.
+
+// Levels stop once both sides are at most this many pixels
+#define PYRAMID_MIN_SIDE 64
+
+typedef struct {
+    image_t* levels;        // levels[0] is the original (not owned)
+    size_t n_levels;        // Levels planned
+    size_t n_ready;         // Levels built so far (atomic)
+    int cancel;             // Set to stop the builder early (atomic)
+    int finished;           // The builder is done (protected by mutex)
+    pthread_mutex_t mutex;
+    pthread_cond_t progress;
+    pthread_t thread;
+    int running;
+} mip_pyramid_t;
+
+// Starts building the pyramid of `original`, which must outlive it.
+// Returns 0 on success, -1 on failure (level 0 is still usable then).
+int pyramid_start(mip_pyramid_t* pyramid, image_t* original);
+
+// Coarsest level built so far with at most `max_level` halvings; its index goes to `level`
+image_t* pyramid_level(mip_pyramid_t* pyramid, size_t max_level, size_t* level);
+
+// Waits until level `level` is built, or the builder stopped short of it
+void pyramid_wait(mip_pyramid_t* pyramid, size_t level);
+
+// Stops the builder and frees the levels it made
+void pyramid_free(mip_pyramid_t* pyramid);
+
+#endif
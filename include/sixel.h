@@ -0,0 +1,20 @@
+#ifndef SIXEL_H
+#define SIXEL_H
+
+#include "image.h"
+#include "arena.h"
+#include "term_writer.h"
+
+// Sixel graphics: a true-pixel preview for terminals that support it.
+// The image is resized with make_resized(), reduced to at most `max_colors`
+// colors (median cut palette + lookup table quantization) and encoded band by
+// band (6 pixel rows each) with run-length compression. The writer is flushed
+// as bands complete, so large previews never hold the whole encoded image.
+
+// Writes a sixel image of at most max_width x max_height pixels (never larger
+// than `original`) to `out`. Temporaries come from `arena` if not NULL.
+// Returns 0 on success, -1 on allocation or write failure.
+int sixel_write(image_t* original, size_t max_width, size_t max_height, size_t max_colors,
+                term_writer_t* out, arena_t* arena);
+
+#endif
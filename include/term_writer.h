@@ -0,0 +1,68 @@
+#ifndef TERM_WRITER_H
+#define TERM_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Buffered, printf-free writer for terminal output.
+// A frame is formatted into one growable buffer and handed to the kernel with a
+// single write() per flush. The term_put_* appenders do not check capacity:
+// call term_writer_reserve() with an upper bound for what follows first.
+
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+    int fd;
+    size_t bytes_written;   // Total bytes flushed over the writer lifetime
+    double write_seconds;   // Total time spent in write() over the writer lifetime
+} term_writer_t;
+
+// Decimal strings for 0-255, without padding
+extern char term_decimal[256][4];
+extern uint8_t term_decimal_length[256];
+
+void term_writer_init(term_writer_t* writer, int fd);
+void term_writer_free(term_writer_t* writer);
+
+// Makes room for `extra` more bytes. Returns 0 on success, -1 on allocation failure.
+int term_writer_reserve(term_writer_t* writer, size_t extra);
+
+// Writes the buffered bytes to the file descriptor and empties the buffer.
+// Returns 0 on success, -1 on write error.
+int term_writer_flush(term_writer_t* writer);
+
+static inline void term_put_char(term_writer_t* writer, char c) {
+    writer->data[writer->length++] = c;
+}
+
+static inline void term_put_bytes(term_writer_t* writer, const char* bytes, size_t n) {
+    memcpy(writer->data + writer->length, bytes, n);
+    writer->length += n;
+}
+
+// Literal strings only: the length is known at compile time
+#define term_put_literal(writer, literal) term_put_bytes((writer), (literal), sizeof(literal) - 1)
+
+static inline void term_put_u8(term_writer_t* writer, uint8_t value) {
+    memcpy(writer->data + writer->length, term_decimal[value], 4);
+    writer->length += term_decimal_length[value];
+}
+
+// Decimal value of any size (cursor rows and columns); at most 20 bytes
+static inline void term_put_uint(term_writer_t* writer, size_t value) {
+    if (value < 256) {
+        term_put_u8(writer, (uint8_t) value);
+        return;
+    }
+    char digits[20];
+    size_t n = 0;
+    while (value > 0) {
+        digits[n++] = (char) ('0' + value % 10);
+        value /= 10;
+    }
+    while (n > 0) writer->data[writer->length++] = digits[--n];
+}
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <stddef.h>
+
+// Process-wide work-stealing thread pool shared by every pipeline stage.
+// Each worker owns a deque of tasks: it pops from the bottom of its own deque
+// and steals from the top of the others when it runs dry, so uneven rows or
+// tiles keep all cores busy. A thread waiting in parallel_for() runs queued
+// tasks itself, so stages may nest parallel loops without deadlocking.
+
+// Work item: process items [begin, end)
+typedef void (*task_fn)(void* arg, size_t begin, size_t end);
+
+// Sets the number of threads (including the caller) used by the pool.
+// 0 = one per online CPU. Only effective before the first parallel_for().
+void threadpool_set_threads(int n_threads);
+
+// Number of threads that run tasks (workers + caller); starts the pool if needed
+size_t threadpool_size(void);
+
+// Splits [0, n_items) in chunks of at most `grain` items, runs them on the pool
+// and returns once all of them have completed.
+void parallel_for(size_t n_items, size_t grain, task_fn fn, void* arg);
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef TRANSCODE_H
+#define TRANSCODE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "image.h"
+#include "video.h"
+
+// Offline conversion of a whole video stream to an ASCII video file.
+// Frames are converted concurrently, one per worker thread, each through
+// process_image_to_grid, and written in order. At most `window` frames are
+// in flight (read but not yet written), which bounds memory: a worker that
+// runs too far ahead of the oldest unfinished frame waits.
+
+typedef struct {
+    size_t n_frames;
+    size_t n_workers;
+    size_t window;
+    double seconds;
+} transcode_stats_t;
+
+// Converts every frame of `stream` with `options` and writes them to `output_path`.
+// window 0 = two frames per worker. fps_num/fps_den are stored in the file.
+// Returns 0 on success, -1 on failure (reported on stderr).
+int transcode_video(video_stream_t* stream, const char* output_path, const export_options_t* options,
+                    size_t window, uint32_t fps_num, uint32_t fps_den, transcode_stats_t* stats);
+
+#endif
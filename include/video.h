@@ -0,0 +1,94 @@
+#ifndef VIDEO_H
+#define VIDEO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// --- Video Streams ---
+// Fixed-size frames read from a file descriptor (a file, or stdin). Two formats:
+//   - raw RGB24: width * height * 3 bytes per frame, size given by the caller;
+//   - YUV4MPEG2 (Y4M): size and frame rate from the stream header, 4:2:0, 4:4:4
+//     or mono planes, converted to RGB24 by video_stream_to_rgb().
+
+typedef enum {
+    VIDEO_RAW_RGB24,
+    VIDEO_Y4M
+} video_format_t;
+
+typedef enum {
+    VIDEO_CHROMA_420,
+    VIDEO_CHROMA_444,
+    VIDEO_CHROMA_MONO
+} video_chroma_t;
+
+typedef struct {
+    int fd;
+    video_format_t format;
+    video_chroma_t chroma;
+    size_t width, height;
+    size_t frame_bytes;         // Size of one frame as read
+    uint32_t fps_num, fps_den;  // Frame rate declared by the stream, 0/0 if unknown
+} video_stream_t;
+
+// width/height > 0: raw RGB24 frames of that size; 0: reads the Y4M header.
+// Returns 0 on success, -1 on error (reported on stderr).
+int video_stream_open(video_stream_t* stream, int fd, size_t width, size_t height);
+
+// Reads the next frame (frame_bytes bytes). Returns 0 on success, -1 at the end of the stream.
+int video_stream_read(video_stream_t* stream, uint8_t* frame);
+
+// Frame rate declared by the stream, 0 if unknown
+double video_stream_fps(const video_stream_t* stream);
+
+// Converts a frame to interleaved RGB24 (`rgb`: width * height * 3 bytes).
+// Raw RGB24 frames are returned as they are, without copy.
+const uint8_t* video_stream_to_rgb(const video_stream_t* stream, const uint8_t* frame, uint8_t* rgb);
+
+// --- Live Reader ---
+// Frames are read by a dedicated thread into preallocated buffers. Only the newest
+// complete frame is kept for the consumer: when a new frame arrives before the
+// previous one was taken, the previous one is dropped, so a slow consumer never
+// falls behind the stream.
+typedef struct video_reader video_reader_t;
+
+typedef struct {
+    const uint8_t* data;    // Frame as read, valid until the next call
+    double arrival;         // Monotonic time at which the frame was fully read
+    uint64_t sequence;      // Index of the frame in the stream
+} video_frame_t;
+
+// Starts reading from `fd`. width/height > 0: raw RGB24 frames of that size;
+// 0: a Y4M header is expected. Returns NULL on error (reported on stderr).
+video_reader_t* video_reader_open(int fd, size_t width, size_t height);
+
+// Stops the thread and frees the buffers (does not close `fd`)
+void video_reader_close(video_reader_t* reader);
+
+// Format of the frames returned by video_reader_next
+const video_stream_t* video_reader_stream(const video_reader_t* reader);
+
+// Waits for a frame newer than the last one returned. Returns 0 on success,
+// -1 at the end of the stream.
+int video_reader_next(video_reader_t* reader, video_frame_t* frame);
+
+// Frames read from the stream so far, and how many of them were dropped
+void video_reader_counts(video_reader_t* reader, uint64_t* n_read, uint64_t* n_dropped);
+
+// --- Latency Statistics ---
+// Fixed 1 ms buckets: nothing is allocated per frame
+
+#define LATENCY_BUCKETS 1000
+
+typedef struct {
+    uint64_t count;
+    double sum;
+    double max;
+    uint32_t buckets[LATENCY_BUCKETS + 1]; // Last bucket: LATENCY_BUCKETS ms and above
+} latency_stats_t;
+
+void latency_stats_add(latency_stats_t* stats, double seconds);
+// Prints count, mean, median, 95th/99th percentile and maximum
+void latency_stats_print(const latency_stats_t* stats, const char* label, FILE* out);
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef VIEWER_H
+#define VIEWER_H
+
+#include "image.h"
+#include "asciiview.h"
+
+// Interactive pan and zoom viewer for the terminal. Keys: + / - zoom, arrows or
+// h j k l pan, f fit the whole image, q or Esc quit. Views are served from a mip
+// pyramid built in the background, and each keypress redraws only the cells that
+// changed. Needs a terminal on stdin and stdout; the keypress-to-frame latency is
+// reported on exit. Returns 0 on success, 1 on failure.
+int run_viewer(asciiview_ctx_t* ctx, image_t* original, const export_options_t* options);
+
+#endif
@@ -0,0 +1,133 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "../include/adaptive.h"
+
+#define PROBE_PAYLOAD_BYTES (16 * 1024)
+#define PROBE_TIMEOUT 2.0                  // Seconds to wait for the terminal's answer
+#define PROBE_PAYLOAD "\x1b[0m"            // Attribute reset: processed, never displayed
+#define POSITION_QUERY "\x1b[6n"           // Answer: "\x1b[<row>;<col>R"
+#define MIN_SAMPLE_BYTES (16 * 1024)
+#define MIN_SAMPLE_SECONDS 0.005
+#define SAMPLE_WEIGHT 0.3                  // Exponential moving average of the throughput
+#define COLUMN_STEP 0.75
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void adaptive_init(adaptive_t* adaptive, double target_ms) {
+    adaptive->target_seconds = target_ms / 1000.0;
+    adaptive->throughput = 0.0;
+    adaptive->n_samples = 0;
+}
+
+// Seconds until the terminal answers a position query sent after `payload_bytes`
+// of payload, or a negative value on timeout. The terminal must be in raw mode.
+static double round_trip(int in_fd, int out_fd, size_t payload_bytes) {
+    size_t unit = sizeof(PROBE_PAYLOAD) - 1;
+    size_t n_units = payload_bytes / unit;
+    size_t length = n_units * unit + sizeof(POSITION_QUERY) - 1;
+    char* buffer = malloc(length);
+    if (!buffer) return -1.0;
+    for (size_t i = 0; i < n_units; i++) memcpy(buffer + i * unit, PROBE_PAYLOAD, unit);
+    memcpy(buffer + n_units * unit, POSITION_QUERY, sizeof(POSITION_QUERY) - 1);
+
+    double start = now_seconds();
+    size_t offset = 0;
+    while (offset < length) {
+        ssize_t n = write(out_fd, buffer + offset, length - offset);
+        if (n <= 0) break;
+        offset += (size_t) n;
+    }
+    free(buffer);
+    if (offset < length) return -1.0;
+
+    // Read up to the 'R' that ends the answer
+    char c;
+    while (now_seconds() - start < PROBE_TIMEOUT) {
+        ssize_t n = read(in_fd, &c, 1);
+        if (n == 1 && c == 'R') return now_seconds() - start;
+    }
+    return -1.0;
+}
+
+int adaptive_probe_terminal(adaptive_t* adaptive, int in_fd, int out_fd) {
+    if (!isatty(in_fd) || !isatty(out_fd)) return -1;
+
+    struct termios saved, raw;
+    if (tcgetattr(in_fd, &saved) != 0) return -1;
+    raw = saved;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 0;
+    raw.c_cc[VTIME] = 1; // Reads return after 0.1 s without input
+    if (tcsetattr(in_fd, TCSANOW, &raw) != 0) return -1;
+
+    // The bare query measures latency; the difference is the payload's transfer time
+    double latency = round_trip(in_fd, out_fd, 0);
+    double loaded = (latency >= 0.0) ? round_trip(in_fd, out_fd, PROBE_PAYLOAD_BYTES) : -1.0;
+    tcsetattr(in_fd, TCSANOW, &saved);
+    if (loaded < 0.0) return -1;
+
+    double transfer = loaded - latency;
+    if (transfer < MIN_SAMPLE_SECONDS) transfer = MIN_SAMPLE_SECONDS;
+    adaptive->throughput = PROBE_PAYLOAD_BYTES / transfer;
+    adaptive->n_samples = 1;
+    return 0;
+}
+
+void adaptive_observe(adaptive_t* adaptive, size_t bytes, double seconds) {
+    if (bytes < MIN_SAMPLE_BYTES || seconds < MIN_SAMPLE_SECONDS) return;
+
+    double sample = bytes / seconds;
+    if (adaptive->n_samples == 0) {
+        adaptive->throughput = sample;
+    } else {
+        adaptive->throughput += SAMPLE_WEIGHT * (sample - adaptive->throughput);
+    }
+    adaptive->n_samples++;
+}
+
+size_t adaptive_budget(const adaptive_t* adaptive) {
+    if (adaptive->n_samples == 0) return 0;
+    return (size_t) (adaptive->throughput * adaptive->target_seconds);
+}
+
+int adaptive_degrade(export_options_t* options) {
+    if (options->color_mode == COLOR_MODE_TRUE) {
+        if (options->color_tolerance < 8.0) { options->color_tolerance = 8.0; return 1; }
+        if (options->color_tolerance < 16.0) { options->color_tolerance = 16.0; return 1; }
+        options->color_mode = COLOR_MODE_256;
+        return 1;
+    }
+    if (options->color_mode == COLOR_MODE_256) {
+        options->color_mode = COLOR_MODE_16;
+        return 1;
+    }
+
+    int columns = (int) (options->width_chars * COLUMN_STEP);
+    if (columns < ADAPTIVE_MIN_COLUMNS) columns = ADAPTIVE_MIN_COLUMNS;
+    if (columns >= options->width_chars) return 0;
+    options->width_chars = columns;
+    return 1;
+}
+
+void adaptive_report(const adaptive_t* adaptive, const export_options_t* options, size_t frame_bytes, FILE* out) {
+    static const char* color_names[] = {"truecolor", "256 colors", "16 colors", "no colors"};
+
+    fprintf(out, "Adaptive: %d columns, %s", options->width_chars, color_names[options->color_mode]);
+    if (options->color_mode == COLOR_MODE_TRUE) fprintf(out, ", tolerance %.0f", options->color_tolerance);
+    fprintf(out, ", %.1f KiB per frame", frame_bytes / 1024.0);
+    if (adaptive->n_samples > 0) {
+        fprintf(out, " (~%.0f ms at %.1f KiB/s)\n", 1000.0 * frame_bytes / adaptive->throughput,
+                adaptive->throughput / 1024.0);
+    } else {
+        fprintf(out, " (throughput not measured yet)\n");
+    }
+}
@@ -0,0 +1,82 @@
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "../include/animation.h"
+#include "../include/process.h"
+#include "../include/threadpool.h"
+
+typedef struct {
+    const animation_t* animation;
+    const export_options_t* options;
+    frame_cache_t* cache;
+    export_options_t first_options; // Options as updated by frame 0
+} convert_job_t;
+
+// Each task converts its own frames with private options and input buffer; the
+// per-frame stages below still spread over the pool (parallel_for nests)
+static void convert_frames(void* arg, size_t begin, size_t end) {
+    convert_job_t* job = arg;
+    const animation_t* animation = job->animation;
+    size_t frame_size = animation->width * animation->height * animation->channels;
+
+    image_t frame = {animation->width, animation->height, animation->channels, NULL};
+    frame.data = malloc(frame_size * sizeof(*frame.data));
+    if (!frame.data) return; // Grids stay empty: reported by the caller
+
+    for (size_t f = begin; f < end; f++) {
+        // Convert to [0., 1.]
+        const uint8_t* pixels = &animation->pixels[f * frame_size];
+        for (size_t i = 0; i < frame_size; i++) {
+            frame.data[i] = pixels[i] / 255.0;
+        }
+
+        export_options_t options = *job->options;
+        job->cache->grids[f] = process_image_to_grid(&frame, &options, NULL);
+        if (f == 0) job->first_options = options;
+    }
+    free(frame.data);
+}
+
+int frame_cache_build(frame_cache_t* cache, const animation_t* animation, export_options_t* options) {
+    *cache = (frame_cache_t) {0};
+    if (!animation || animation->n_frames == 0) return -1;
+
+    cache->grids = calloc(animation->n_frames, sizeof(*cache->grids));
+    cache->delays_ms = malloc(animation->n_frames * sizeof(*cache->delays_ms));
+    if (!cache->grids || !cache->delays_ms) {
+        fprintf(stderr, "Error: Failed to allocate memory for animation frames!\n");
+        frame_cache_free(cache);
+        return -1;
+    }
+    cache->n_frames = animation->n_frames;
+
+    for (size_t f = 0; f < animation->n_frames; f++) {
+        int delay = animation->delays_ms[f];
+        cache->delays_ms[f] = (delay < ANIMATION_MIN_DELAY_MS) ? ANIMATION_DEFAULT_DELAY_MS : delay;
+    }
+
+    convert_job_t job = {animation, options, cache, *options};
+    parallel_for(animation->n_frames, 1, convert_frames, &job);
+
+    for (size_t f = 0; f < cache->n_frames; f++) {
+        if (!cache->grids[f].chars) {
+            fprintf(stderr, "Error: Failed to convert animation frame %zu!\n", f);
+            frame_cache_free(cache);
+            return -1;
+        }
+    }
+    *options = job.first_options;
+    return 0;
+}
+
+void frame_cache_free(frame_cache_t* cache) {
+    if (!cache) return;
+    if (cache->grids) {
+        for (size_t f = 0; f < cache->n_frames; f++) {
+            free_ascii_grid(&cache->grids[f]);
+        }
+    }
+    free(cache->grids);
+    free(cache->delays_ms);
+    *cache = (frame_cache_t) {0};
+}
@@ -0,0 +1,105 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../include/arena.h"
+
+#define DEFAULT_BLOCK_SIZE (1 << 20)
+
+static size_t align_up(size_t value) {
+    return (value + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1);
+}
+
+// The block header lives at the start of its own allocation: one heap call per block
+static arena_block_t* new_block(arena_t* arena, size_t size) {
+    size_t header = align_up(sizeof(arena_block_t));
+    unsigned char* memory = aligned_alloc(ARENA_ALIGNMENT, header + align_up(size));
+    if (!memory) return NULL;
+
+    arena_block_t* block = (arena_block_t*) memory;
+    block->data = memory + header;
+    block->size = align_up(size);
+    block->used = 0;
+    block->next = NULL;
+    arena->n_heap_allocs++;
+    return block;
+}
+
+static void free_blocks(arena_block_t* block) {
+    while (block) {
+        arena_block_t* next = block->next;
+        free(block);
+        block = next;
+    }
+}
+
+void arena_init(arena_t* arena, size_t block_size) {
+    memset(arena, 0, sizeof(*arena));
+    arena->block_size = (block_size > 0) ? block_size : DEFAULT_BLOCK_SIZE;
+}
+
+void* arena_alloc(arena_t* arena, size_t size) {
+    size = align_up(size > 0 ? size : 1);
+
+    arena_block_t* block = arena->blocks;
+    if (!block || block->size - block->used < size) {
+        size_t block_size = (size > arena->block_size) ? size : arena->block_size;
+        block = new_block(arena, block_size);
+        if (!block) return NULL;
+        block->next = arena->blocks;
+        arena->blocks = block;
+    }
+
+    void* ptr = block->data + block->used;
+    block->used += size;
+    arena->n_allocs++;
+    arena->bytes_used += size;
+    if (arena->bytes_used > arena->peak_bytes) arena->peak_bytes = arena->bytes_used;
+    return ptr;
+}
+
+void* arena_calloc(arena_t* arena, size_t count, size_t size) {
+    if (size && count > SIZE_MAX / size) return NULL;
+    void* ptr = arena_alloc(arena, count * size);
+    if (ptr) memset(ptr, 0, count * size);
+    return ptr;
+}
+
+void arena_reset(arena_t* arena) {
+    arena_block_t* block = arena->blocks;
+
+    // Several blocks means the working set outgrew the first one:
+    // replace them with a single block sized for the peak
+    if (block && block->next) {
+        size_t total = 0;
+        for (arena_block_t* b = block; b; b = b->next) total += b->size;
+        free_blocks(block);
+        arena->blocks = NULL;
+        if (total < arena->peak_bytes) total = arena->peak_bytes;
+        arena->blocks = new_block(arena, total);
+    } else if (block) {
+        block->used = 0;
+    }
+
+    arena->n_allocs = 0;
+    arena->bytes_used = 0;
+    arena->n_resets++;
+}
+
+void arena_free(arena_t* arena) {
+    free_blocks(arena->blocks);
+    arena->blocks = NULL;
+}
+
+void arena_print_stats(const arena_t* arena, FILE* out) {
+    size_t capacity = 0, n_blocks = 0;
+    for (arena_block_t* b = arena->blocks; b; b = b->next) {
+        capacity += b->size;
+        n_blocks++;
+    }
+
+    fprintf(out, "Arena: %zu allocations (%.1f KiB) this round, peak %.1f KiB, "
+                 "%zu heap allocations over %zu resets, %zu block(s) / %.1f KiB reserved\n",
+            arena->n_allocs, arena->bytes_used / 1024.0, arena->peak_bytes / 1024.0,
+            arena->n_heap_allocs, arena->n_resets, n_blocks, capacity / 1024.0);
+}
@@ -19,13 +19,39 @@
 
 void print_help(char* exec_alias) {
     printf("USAGE:\n");
-    printf("\t%s <path/to/image> [OPTIONS]\n\n", exec_alias);
+    printf("\t%s <path/to/image> [more images...] [OPTIONS]\n", exec_alias);
+    printf("\t<video source> | %s - [OPTIONS]\t(Y4M, or raw RGB24 frames with --video)\n\n", exec_alias);
 
     printf("GENERAL OPTIONS:\n");
     printf("\t--width, -w <n>\t\tSet width in characters (overrides terminal width)\n");
     printf("\t--scale, -s <n>\t\tScale factor (1 char = n pixels). Good for keeping resolution.\n");
     printf("\t--dims <WxH>\t\tTarget output resolution in pixels (e.g. 1920x1080). Forces square cells.\n");
+    printf("\t--crop <x,y,w,h>\tOnly convert this region of the source, in pixels or with %% (e.g. 25%%,25%%,50%%,50%%)\n");
+    printf("\t--threads <n>\t\tWorker threads shared by all stages (default: one per CPU)\n");
+    printf("\t--watch\t\t\tKeep running and render the image again whenever the file changes\n");
+    printf("\t--stats\t\t\tReport allocation counts on stderr\n");
+    printf("\t--cpu-info\t\tReport the SIMD kernel path selected for this CPU\n");
     
+    printf("\nTERMINAL OPTIONS:\n");
+    printf("\t--mode <mode>\t\tCell glyphs: ascii (default), half (2 samples per cell) or braille (2x4 dots)\n");
+    printf("\t--colors <mode>\t\tTerminal colors: true (default), 256, 16 or none\n");
+    printf("\t--loops <n>\t\tPlay animated GIFs and ASCII videos n times (default: 0 = forever)\n");
+    printf("\t--adaptive <ms>\t\tLower columns/colors until a frame takes at most ms to reach the terminal\n");
+    printf("\t--video <WxH>\t\tRead raw RGB24 frames of WxH pixels from stdin (file name '-')\n");
+    printf("\t--fps <n>\t\tFrames per second shown from stdin (default: Y4M rate or 30; late frames are dropped) or from an ASCII video\n");
+    printf("\t--interactive, -i\tPan and zoom around the image with the keyboard (+/-, arrows, f, q)\n");
+    printf("\t--sixel\t\t\tAlso print a Sixel graphics preview (terminals with Sixel support)\n");
+    printf("\t--delay <s>\t\tSeconds between images when several files are given (default: 2)\n");
+    printf("\t--color-tolerance <d>\tReuse the previous color when the next one differs by less than d (0-255 scale)\n");
+    
+    printf("\nGRID FILES:\n");
+    printf("\t--save-grid <file>\tSave the converted grid instead of printing it; pass the file as input to render it again\n");
+    printf("\t--grid-rle\t\tCompress the saved grid (smaller, but decoded instead of mapped when loaded)\n");
+
+    printf("\nVIDEO TRANSCODING:\n");
+    printf("\t--transcode <file>\tConvert a Y4M (or --video raw RGB24) file to an ASCII video file, using every core\n");
+    printf("\t--window <n>\t\tFrames in flight while transcoding (default: 2 per thread); bounds memory\n");
+
     printf("\nEXPORT OPTIONS:\n");
     printf("\t--export, -e\t\tSave output to image file instead of printing to terminal\n");
     printf("\t--output, -o <file>\tSpecify output filename. Default: input_name.png\n");
@@ -33,6 +59,8 @@ void print_help(char* exec_alias) {
     printf("\t--font <name>\t\tFont family for export (default: %s)\n", DEFAULT_FONT);
     printf("\t--bg-white\t\tUse white background (default: black)\n");
     printf("\t--retro-colors\t\tUse 3-bit retro color palette (8 colors)\n");
+    printf("\t--no-edges\t\tDisable edge detection (faster, value characters only)\n");
+    printf("\t--palette <n>\t\tUse an adaptive palette of n colors (2-256) computed from the image\n");
 }
 
 // Helper: Get terminal size
@@ -46,9 +74,10 @@ int try_get_terminal_size(int* width, int* height) {
     *width = csbi.srWindow.Right - csbi.srWindow.Left + 1;
     *height = csbi.srWindow.Bottom - csbi.srWindow.Top + 1;
 #else
-    if (!isatty(0)) return 0;
+    int fd = isatty(1) ? 1 : 0; // stdin may be a pipe (video input)
+    if (!isatty(fd)) return 0;
     struct winsize ws;
-    if (ioctl(0, TIOCGWINSZ, &ws) == 0) {
+    if (ioctl(fd, TIOCGWINSZ, &ws) == 0) {
         *width = ws.ws_col;
         *height = ws.ws_row;
         return 1;
@@ -57,11 +86,49 @@ int try_get_terminal_size(int* width, int* height) {
     return 0;
 }
 
+// Parses "x,y,w,h" where each value is a number of pixels or a percentage
+static int parse_crop(const char* text, struct arguments* args) {
+    const char* p = text;
+    for (int k = 0; k < 4; k++) {
+        char* end;
+        double value = strtod(p, &end);
+        if (end == p || value < 0.0) return -1;
+        args->crop_percent[k] = (*end == '%');
+        if (args->crop_percent[k]) end++;
+        if (args->crop_percent[k] && value > 100.0) return -1;
+        args->crop[k] = value;
+        if (*end != (k < 3 ? ',' : '\0')) return -1;
+        p = end + 1;
+    }
+    if (args->crop[2] <= 0.0 || args->crop[3] <= 0.0) return -1;
+    args->has_crop = 1;
+    return 0;
+}
+
 struct arguments parse_args(int argc, char *argv[]) {
     struct arguments args;
     // Init defaults
     args.filename = NULL;
+    args.filenames = NULL;
+    args.n_files = 0;
+    args.delay = 2.0;
+    args.adaptive_ms = 0.0;
+    args.loops = 0;
+    args.video_width = 0;
+    args.video_height = 0;
+    args.fps = 0.0;
+    args.transcode_path = NULL;
+    args.grid_path = NULL;
+    args.grid_rle = 0;
+    args.window = 0;
     args.width = 0; // 0 means auto/terminal
+    args.threads = 0; // 0 means one per CPU
+    args.print_cpu_info = 0;
+    args.watch = 0;
+    args.interactive = 0;
+    args.has_crop = 0;
+    memset(args.crop, 0, sizeof(args.crop));
+    memset(args.crop_percent, 0, sizeof(args.crop_percent));
     
     // Init export options defaults
     args.options.export_image = 0;
@@ -74,6 +141,14 @@ struct arguments parse_args(int argc, char *argv[]) {
     args.options.target_pixel_h = 0;
     args.options.scale_factor = 0;
     args.options.use_retro_colors = 0;
+    args.options.palette_size = 0;
+    args.options.disable_edges = 0;
+    args.options.glyph_mode = GLYPH_MODE_ASCII;
+    args.options.color_mode = COLOR_MODE_TRUE;
+    args.options.color_tolerance = 0.0;
+    args.options.sixel_preview = 0;
+    args.options.print_stats = 0;
+    args.options.crop = (image_region_t) {0};
 
     if (argc < 2) {
         print_help(argv[0]);
@@ -86,10 +161,28 @@ struct arguments parse_args(int argc, char *argv[]) {
         args.filename = NULL; // Signal invalid
         return args;
     }
+    if (strcmp(args.filename, "--cpu-info") == 0) {
+        args.print_cpu_info = 1;
+        args.filename = NULL; // Nothing to convert
+        return args;
+    }
+
+    // Positional arguments after the first one make a slideshow
+    args.filenames = malloc(argc * sizeof(*args.filenames));
+    if (!args.filenames) {
+        fprintf(stderr, "Error: Failed to allocate memory for arguments!\n");
+        args.filename = NULL;
+        return args;
+    }
+    args.filenames[args.n_files++] = args.filename;
 
     for (int i = 2; i < argc; i++) {
+        // More images
+        if (argv[i][0] != '-') {
+            args.filenames[args.n_files++] = argv[i];
+        }
         // Width
-        if ((strcmp(argv[i], "--width") == 0 || strcmp(argv[i], "-w") == 0) && i + 1 < argc) {
+        else if ((strcmp(argv[i], "--width") == 0 || strcmp(argv[i], "-w") == 0) && i + 1 < argc) {
             args.width = atoi(argv[++i]);
             args.options.width_chars = args.width;
         }
@@ -118,10 +211,120 @@ struct arguments parse_args(int argc, char *argv[]) {
         else if (strcmp(argv[i], "--retro-colors") == 0) {
             args.options.use_retro_colors = 1;
         }
+        // Glyph mode
+        else if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            const char* mode = argv[++i];
+            if (strcmp(mode, "ascii") == 0) args.options.glyph_mode = GLYPH_MODE_ASCII;
+            else if (strcmp(mode, "half") == 0) args.options.glyph_mode = GLYPH_MODE_HALF;
+            else if (strcmp(mode, "braille") == 0) args.options.glyph_mode = GLYPH_MODE_BRAILLE;
+            else fprintf(stderr, "Warning: Unknown mode '%s', using ascii.\n", mode);
+        }
+        // Terminal color mode
+        else if (strcmp(argv[i], "--colors") == 0 && i + 1 < argc) {
+            const char* mode = argv[++i];
+            if (strcmp(mode, "true") == 0 || strcmp(mode, "24") == 0) args.options.color_mode = COLOR_MODE_TRUE;
+            else if (strcmp(mode, "256") == 0) args.options.color_mode = COLOR_MODE_256;
+            else if (strcmp(mode, "16") == 0) args.options.color_mode = COLOR_MODE_16;
+            else if (strcmp(mode, "none") == 0) args.options.color_mode = COLOR_MODE_NONE;
+            else fprintf(stderr, "Warning: Unknown color mode '%s', using true color.\n", mode);
+        }
+        // Color run tolerance
+        else if (strcmp(argv[i], "--color-tolerance") == 0 && i + 1 < argc) {
+            args.options.color_tolerance = atof(argv[++i]);
+            if (args.options.color_tolerance < 0.0) args.options.color_tolerance = 0.0;
+        }
+        // Edge detection
+        else if (strcmp(argv[i], "--no-edges") == 0) {
+            args.options.disable_edges = 1;
+        }
+        // Adaptive palette
+        else if (strcmp(argv[i], "--palette") == 0 && i + 1 < argc) {
+            args.options.palette_size = atoi(argv[++i]);
+            if (args.options.palette_size < 0) args.options.palette_size = 0;
+            if (args.options.palette_size == 1) args.options.palette_size = 2;
+            if (args.options.palette_size > 256) args.options.palette_size = 256;
+        }
+        // Threads
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            args.threads = atoi(argv[++i]);
+            if (args.threads < 0) args.threads = 0;
+        }
+        // Animation loops
+        else if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc) {
+            args.loops = atoi(argv[++i]);
+            if (args.loops < 0) args.loops = 0;
+        }
+        // Throughput-adaptive output
+        else if (strcmp(argv[i], "--adaptive") == 0 && i + 1 < argc) {
+            args.adaptive_ms = atof(argv[++i]);
+            if (args.adaptive_ms < 0.0) args.adaptive_ms = 0.0;
+        }
+        // Interactive viewer
+        else if (strcmp(argv[i], "--interactive") == 0 || strcmp(argv[i], "-i") == 0) {
+            args.interactive = 1;
+        }
+        // Sixel preview
+        else if (strcmp(argv[i], "--sixel") == 0) {
+            args.options.sixel_preview = 1;
+        }
+        // Re-render on file changes
+        else if (strcmp(argv[i], "--watch") == 0) {
+            args.watch = 1;
+        }
+        // Slideshow delay
+        else if (strcmp(argv[i], "--delay") == 0 && i + 1 < argc) {
+            args.delay = atof(argv[++i]);
+            if (args.delay < 0.0) args.delay = 0.0;
+        }
+        // Raw video from stdin
+        else if (strcmp(argv[i], "--video") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &args.video_width, &args.video_height) != 2 ||
+                args.video_width <= 0 || args.video_height <= 0) {
+                fprintf(stderr, "Warning: Invalid video size '%s', expecting Y4M.\n", argv[i]);
+                args.video_width = args.video_height = 0;
+            }
+        }
+        // Grid files
+        else if (strcmp(argv[i], "--save-grid") == 0 && i + 1 < argc) {
+            free(args.grid_path);
+            args.grid_path = strdup(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--grid-rle") == 0) {
+            args.grid_rle = 1;
+        }
+        // Offline transcoding
+        else if (strcmp(argv[i], "--transcode") == 0 && i + 1 < argc) {
+            free(args.transcode_path);
+            args.transcode_path = strdup(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc) {
+            args.window = atoi(argv[++i]);
+            if (args.window < 0) args.window = 0;
+        }
+        // Video frame rate
+        else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            args.fps = atof(argv[++i]);
+            if (args.fps < 0.0) args.fps = 0.0;
+        }
+        // CPU dispatch info
+        else if (strcmp(argv[i], "--cpu-info") == 0) {
+            args.print_cpu_info = 1;
+        }
+        // Statistics
+        else if (strcmp(argv[i], "--stats") == 0) {
+            args.options.print_stats = 1;
+        }
         // Scale
         else if ((strcmp(argv[i], "--scale") == 0 || strcmp(argv[i], "-s") == 0) && i + 1 < argc) {
             args.options.scale_factor = atoi(argv[++i]);
         }
+        // Region of interest (x,y,w,h, each in pixels or %)
+        else if (strcmp(argv[i], "--crop") == 0 && i + 1 < argc) {
+            if (parse_crop(argv[++i], &args) != 0) {
+                fprintf(stderr, "Warning: Invalid crop '%s', expecting x,y,w,h (pixels or %%), converting the whole image.\n", argv[i]);
+                args.has_crop = 0;
+            }
+        }
         // Dims (WxH)
         else if (strcmp(argv[i], "--dims") == 0 && i + 1 < argc) {
             char* val = argv[++i];
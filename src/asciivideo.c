@@ -0,0 +1,531 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "../include/asciivideo.h"
+#include "../include/packbits.h"
+
+#define HEADER_SIZE 24
+#define RECORD_HEADER_SIZE 5
+#define KEYFRAME_HEADER_SIZE 12
+#define MAX_PLANES 11
+#define MAX_VARINT_BYTES 10
+#define MAX_DIMENSION 65536
+#define MAX_CELLS ((size_t) 1 << 26)
+// Unchanged cells absorbed into a run rather than starting a new one: a run
+// costs two varints in the file and a cursor move on the terminal
+#define MERGE_GAP 4
+
+#define RECORD_KEYFRAME 'K'
+#define RECORD_DELTA 'D'
+
+// --- Little-Endian Helpers ---
+
+static void put_u32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) out[i] = (uint8_t) (value >> (8 * i));
+}
+
+static uint32_t get_u32(const uint8_t* in) {
+    return (uint32_t) in[0] | ((uint32_t) in[1] << 8) | ((uint32_t) in[2] << 16) | ((uint32_t) in[3] << 24);
+}
+
+static size_t put_varint(uint8_t* out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t) (value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t) value;
+    return n;
+}
+
+// Reads a varint at in[*pos], without going past `size`. Returns 0 on success, -1 if malformed.
+static int get_varint(const uint8_t* in, size_t size, size_t* pos, uint64_t* value) {
+    *value = 0;
+    for (int shift = 0; shift < 7 * MAX_VARINT_BYTES && *pos < size; shift += 7) {
+        uint8_t byte = in[(*pos)++];
+        *value |= (uint64_t) (byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return 0;
+    }
+    return -1;
+}
+
+// --- Planes ---
+
+// One byte per cell: either a byte plane of the grid or one byte of each glyph
+typedef struct {
+    uint8_t* bytes;
+    uint32_t* words;
+    int shift;
+} plane_t;
+
+static size_t list_planes(const ascii_grid_t* grid, plane_t* planes) {
+    size_t n = 0;
+    planes[n++] = (plane_t) {(uint8_t*) grid->chars, NULL, 0};
+    planes[n++] = (plane_t) {grid->r, NULL, 0};
+    planes[n++] = (plane_t) {grid->g, NULL, 0};
+    planes[n++] = (plane_t) {grid->b, NULL, 0};
+    if (grid->glyphs) {
+        for (int shift = 0; shift < 32; shift += 8) planes[n++] = (plane_t) {NULL, grid->glyphs, shift};
+    }
+    if (grid->bg_r) {
+        planes[n++] = (plane_t) {grid->bg_r, NULL, 0};
+        planes[n++] = (plane_t) {grid->bg_g, NULL, 0};
+        planes[n++] = (plane_t) {grid->bg_b, NULL, 0};
+    }
+    return n;
+}
+
+static size_t count_planes(uint32_t flags) {
+    return 4 + ((flags & ASCIIVIDEO_GLYPHS) ? 4 : 0) + ((flags & ASCIIVIDEO_BACKGROUND) ? 3 : 0);
+}
+
+static uint32_t grid_flags(const ascii_grid_t* grid) {
+    return (grid->glyphs ? ASCIIVIDEO_GLYPHS : 0) | (grid->bg_r ? ASCIIVIDEO_BACKGROUND : 0);
+}
+
+static void gather(const plane_t* plane, const grid_span_t* runs, size_t n_runs, uint8_t* out) {
+    for (size_t r = 0; r < n_runs; r++) {
+        size_t start = runs[r].start, length = runs[r].length;
+        if (plane->bytes) {
+            memcpy(out, plane->bytes + start, length);
+        } else {
+            for (size_t i = 0; i < length; i++) out[i] = (uint8_t) (plane->words[start + i] >> plane->shift);
+        }
+        out += length;
+    }
+}
+
+static void scatter(const plane_t* plane, const grid_span_t* runs, size_t n_runs, const uint8_t* in) {
+    uint32_t mask = ~((uint32_t) 0xFF << plane->shift);
+    for (size_t r = 0; r < n_runs; r++) {
+        size_t start = runs[r].start, length = runs[r].length;
+        if (plane->bytes) {
+            memcpy(plane->bytes + start, in, length);
+        } else {
+            for (size_t i = 0; i < length; i++) {
+                plane->words[start + i] = (plane->words[start + i] & mask) | ((uint32_t) in[i] << plane->shift);
+            }
+        }
+        in += length;
+    }
+}
+
+// --- Runs ---
+
+static int same_layout(const ascii_grid_t* a, const ascii_grid_t* b) {
+    return a->chars && b->chars && a->width == b->width && a->height == b->height &&
+           (a->glyphs != NULL) == (b->glyphs != NULL) && (a->bg_r != NULL) == (b->bg_r != NULL);
+}
+
+static int same_cell(const ascii_grid_t* a, const ascii_grid_t* b, size_t i) {
+    if (a->chars[i] != b->chars[i] || a->r[i] != b->r[i] || a->g[i] != b->g[i] || a->b[i] != b->b[i]) return 0;
+    if (a->glyphs && a->glyphs[i] != b->glyphs[i]) return 0;
+    if (a->bg_r && (a->bg_r[i] != b->bg_r[i] || a->bg_g[i] != b->bg_g[i] || a->bg_b[i] != b->bg_b[i])) return 0;
+    return 1;
+}
+
+// Most runs a grid can split into: changed cells alternating with unchanged ones
+static size_t max_runs(size_t width, size_t height) {
+    return height * ((width + 1) / 2);
+}
+
+// Runs of cells where `a` and `b` (same layout) differ, row by row
+static size_t diff_runs(const ascii_grid_t* a, const ascii_grid_t* b, grid_span_t* runs) {
+    size_t n = 0;
+    for (size_t y = 0; y < a->height; y++) {
+        size_t row = y * a->width;
+        size_t x = 0;
+        while (x < a->width) {
+            if (same_cell(a, b, row + x)) {
+                x++;
+                continue;
+            }
+            size_t start = x, end = x + 1; // end: past the last changed cell
+            for (x = end; x < a->width && x - end <= MERGE_GAP; x++) {
+                if (!same_cell(a, b, row + x)) end = x + 1;
+            }
+            runs[n++] = (grid_span_t) {row + start, end - start};
+            x = end;
+        }
+    }
+    return n;
+}
+
+static size_t full_rows(size_t width, size_t height, grid_span_t* runs) {
+    for (size_t y = 0; y < height; y++) runs[y] = (grid_span_t) {y * width, width};
+    return height;
+}
+
+// --- Codec Buffers ---
+
+// Buffers sized for one grid layout, shared by the writer and the reader
+typedef struct {
+    size_t width, height;
+    uint32_t flags;
+    grid_span_t* runs;
+    uint8_t* values;        // Plane values of the cells being coded
+    uint8_t* packed;        // PackBits coding of `values`
+    uint8_t* payload;
+    size_t payload_capacity;
+} codec_t;
+
+// Largest record payload for a layout (a delta of every run can exceed a keyframe)
+static size_t payload_bound(size_t width, size_t height, uint32_t flags) {
+    size_t n_cells = width * height;
+    size_t delta_runs = MAX_VARINT_BYTES + 2 * MAX_VARINT_BYTES * max_runs(width, height);
+    return KEYFRAME_HEADER_SIZE + delta_runs + count_planes(flags) * (MAX_VARINT_BYTES + packbits_bound(n_cells));
+}
+
+static void free_codec(codec_t* codec) {
+    free(codec->runs);
+    free(codec->values);
+    free(codec->packed);
+    free(codec->payload);
+    *codec = (codec_t) {0};
+}
+
+static int reserve_codec(codec_t* codec, size_t width, size_t height, uint32_t flags) {
+    if (codec->payload && codec->width == width && codec->height == height && codec->flags == flags) return 0;
+
+    free_codec(codec);
+    size_t n_cells = width * height;
+    codec->runs = malloc(max_runs(width, height) * sizeof(*codec->runs));
+    codec->values = malloc(n_cells);
+    codec->packed = malloc(packbits_bound(n_cells));
+    codec->payload_capacity = payload_bound(width, height, flags);
+    codec->payload = malloc(codec->payload_capacity);
+    if (!codec->runs || !codec->values || !codec->packed || !codec->payload) {
+        free_codec(codec);
+        return -1;
+    }
+    codec->width = width;
+    codec->height = height;
+    codec->flags = flags;
+    return 0;
+}
+
+// --- Writer ---
+
+struct asciivideo_writer {
+    FILE* file;
+    int failed;
+    uint32_t keyframe_interval;
+    uint64_t n_frames;
+    ascii_grid_t previous;  // Last frame written, for the next delta
+    codec_t codec;
+};
+
+static void put_bytes(asciivideo_writer_t* writer, const void* data, size_t length) {
+    if (length > 0 && fwrite(data, 1, length, writer->file) != length) writer->failed = 1;
+}
+
+asciivideo_writer_t* asciivideo_writer_open(const char* path, uint32_t fps_num, uint32_t fps_den,
+                                            uint32_t keyframe_interval) {
+    asciivideo_writer_t* writer = calloc(1, sizeof(*writer));
+    if (!writer) {
+        fprintf(stderr, "Error: Failed to allocate memory for video writer!\n");
+        return NULL;
+    }
+    writer->file = fopen(path, "wb");
+    if (!writer->file) {
+        fprintf(stderr, "Error: Could not create %s!\n", path);
+        free(writer);
+        return NULL;
+    }
+    writer->keyframe_interval = keyframe_interval > 0 ? keyframe_interval : ASCIIVIDEO_KEYFRAME_INTERVAL;
+
+    uint8_t header[HEADER_SIZE];
+    memcpy(header, ASCIIVIDEO_MAGIC, 8);
+    put_u32(header + 8, ASCIIVIDEO_VERSION);
+    put_u32(header + 12, fps_num);
+    put_u32(header + 16, fps_den);
+    put_u32(header + 20, writer->keyframe_interval);
+    put_bytes(writer, header, HEADER_SIZE);
+    return writer;
+}
+
+// Appends the varint size and PackBits coding of `length` values to the payload
+static size_t put_packed(codec_t* codec, size_t size, const uint8_t* values, size_t length) {
+    size_t packed_size = packbits_encode(values, length, codec->packed);
+    size += put_varint(codec->payload + size, packed_size);
+    memcpy(codec->payload + size, codec->packed, packed_size);
+    return size + packed_size;
+}
+
+static size_t encode_keyframe(codec_t* codec, const ascii_grid_t* grid) {
+    size_t n_cells = grid->width * grid->height;
+    put_u32(codec->payload, (uint32_t) grid->width);
+    put_u32(codec->payload + 4, (uint32_t) grid->height);
+    put_u32(codec->payload + 8, grid_flags(grid));
+    size_t size = KEYFRAME_HEADER_SIZE;
+
+    plane_t planes[MAX_PLANES];
+    size_t n_planes = list_planes(grid, planes);
+    grid_span_t all = {0, n_cells};
+    for (size_t p = 0; p < n_planes; p++) {
+        const uint8_t* values = planes[p].bytes;
+        if (!values) {
+            gather(&planes[p], &all, 1, codec->values);
+            values = codec->values;
+        }
+        size = put_packed(codec, size, values, n_cells);
+    }
+    return size;
+}
+
+static size_t encode_delta(codec_t* codec, const ascii_grid_t* grid, const ascii_grid_t* previous) {
+    size_t n_runs = diff_runs(grid, previous, codec->runs);
+    size_t size = put_varint(codec->payload, n_runs);
+    size_t end = 0, n_values = 0;
+    for (size_t r = 0; r < n_runs; r++) {
+        size += put_varint(codec->payload + size, codec->runs[r].start - end);
+        size += put_varint(codec->payload + size, codec->runs[r].length);
+        end = codec->runs[r].start + codec->runs[r].length;
+        n_values += codec->runs[r].length;
+    }
+    if (n_runs == 0) return size;
+
+    plane_t planes[MAX_PLANES];
+    size_t n_planes = list_planes(grid, planes);
+    for (size_t p = 0; p < n_planes; p++) {
+        gather(&planes[p], codec->runs, n_runs, codec->values);
+        size = put_packed(codec, size, codec->values, n_values);
+    }
+    return size;
+}
+
+int asciivideo_write_frame(asciivideo_writer_t* writer, const ascii_grid_t* grid) {
+    if (!grid->chars) return -1;
+    if (reserve_codec(&writer->codec, grid->width, grid->height, grid_flags(grid)) != 0) {
+        fprintf(stderr, "Error: Failed to allocate memory for video frame!\n");
+        return -1;
+    }
+
+    int keyframe = !same_layout(grid, &writer->previous) || writer->n_frames % writer->keyframe_interval == 0;
+    size_t size = keyframe ? encode_keyframe(&writer->codec, grid)
+                           : encode_delta(&writer->codec, grid, &writer->previous);
+
+    uint8_t record[RECORD_HEADER_SIZE] = {keyframe ? RECORD_KEYFRAME : RECORD_DELTA};
+    put_u32(record + 1, (uint32_t) size);
+    put_bytes(writer, record, RECORD_HEADER_SIZE);
+    put_bytes(writer, writer->codec.payload, size);
+
+    if (copy_ascii_grid(&writer->previous, grid) != 0) {
+        fprintf(stderr, "Error: Failed to allocate memory for video frame!\n");
+        writer->failed = 1;
+    }
+    writer->n_frames++;
+    return writer->failed ? -1 : 0;
+}
+
+int asciivideo_writer_close(asciivideo_writer_t* writer) {
+    if (!writer) return -1;
+    if (fclose(writer->file) != 0) writer->failed = 1;
+    int status = writer->failed ? -1 : 0;
+    free_ascii_grid(&writer->previous);
+    free_codec(&writer->codec);
+    free(writer);
+    return status;
+}
+
+// --- Reader ---
+
+struct asciivideo_reader {
+    FILE* file;
+    uint32_t fps_num, fps_den;
+    ascii_grid_t grid;      // Current frame
+    ascii_grid_t scratch;   // Next keyframe, compared with the current frame
+    codec_t codec;
+    int clear_next;
+};
+
+int asciivideo_probe(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return 0;
+    char magic[8];
+    int match = fread(magic, 1, 8, file) == 8 && memcmp(magic, ASCIIVIDEO_MAGIC, 8) == 0;
+    fclose(file);
+    return match;
+}
+
+asciivideo_reader_t* asciivideo_reader_open(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open %s.\n", path);
+        return NULL;
+    }
+
+    uint8_t header[HEADER_SIZE];
+    if (fread(header, 1, HEADER_SIZE, file) != HEADER_SIZE || memcmp(header, ASCIIVIDEO_MAGIC, 8) != 0 ||
+        get_u32(header + 8) != ASCIIVIDEO_VERSION) {
+        fprintf(stderr, "Error: %s is not a supported ASCII video file!\n", path);
+        fclose(file);
+        return NULL;
+    }
+
+    asciivideo_reader_t* reader = calloc(1, sizeof(*reader));
+    if (!reader) {
+        fprintf(stderr, "Error: Failed to allocate memory for video reader!\n");
+        fclose(file);
+        return NULL;
+    }
+    reader->file = file;
+    reader->fps_num = get_u32(header + 12);
+    reader->fps_den = get_u32(header + 16);
+    reader->clear_next = 1;
+    return reader;
+}
+
+double asciivideo_reader_fps(const asciivideo_reader_t* reader) {
+    return reader->fps_den > 0 ? (double) reader->fps_num / reader->fps_den : 0.0;
+}
+
+// Decodes the planes of a payload (from `pos`) into the cells of `runs`
+static int decode_planes(codec_t* codec, size_t size, size_t pos, const ascii_grid_t* grid,
+                         const grid_span_t* runs, size_t n_runs, size_t n_values) {
+    plane_t planes[MAX_PLANES];
+    size_t n_planes = list_planes(grid, planes);
+    for (size_t p = 0; p < n_planes; p++) {
+        uint64_t packed_size;
+        if (get_varint(codec->payload, size, &pos, &packed_size) != 0 || packed_size > size - pos ||
+            packbits_decode(codec->payload + pos, (size_t) packed_size, codec->values, n_values) != 0) {
+            return -1;
+        }
+        scatter(&planes[p], runs, n_runs, codec->values);
+        pos += (size_t) packed_size;
+    }
+    return pos == size ? 0 : -1;
+}
+
+static int read_keyframe(asciivideo_reader_t* reader, size_t size, asciivideo_frame_t* frame) {
+    uint8_t header[KEYFRAME_HEADER_SIZE];
+    if (size < KEYFRAME_HEADER_SIZE || fread(header, 1, KEYFRAME_HEADER_SIZE, reader->file) != KEYFRAME_HEADER_SIZE) {
+        return -1;
+    }
+    size_t width = get_u32(header), height = get_u32(header + 4);
+    uint32_t flags = get_u32(header + 8);
+    if (width == 0 || height == 0 || width > MAX_DIMENSION || height > MAX_DIMENSION ||
+        width * height > MAX_CELLS || (flags & ~(uint32_t) (ASCIIVIDEO_GLYPHS | ASCIIVIDEO_BACKGROUND)) ||
+        ((flags & ASCIIVIDEO_BACKGROUND) && !(flags & ASCIIVIDEO_GLYPHS))) {
+        return -1;
+    }
+
+    codec_t* codec = &reader->codec;
+    ascii_grid_t* next = &reader->scratch;
+    int reuse = next->chars && next->width == width && next->height == height && grid_flags(next) == flags;
+    if (!reuse) {
+        free_ascii_grid(next);
+        if (alloc_ascii_grid(next, width, height, NULL) != 0 ||
+            ((flags & ASCIIVIDEO_GLYPHS) && alloc_grid_glyphs(next, (flags & ASCIIVIDEO_BACKGROUND) != 0, NULL) != 0)) {
+            free_ascii_grid(next);
+            return -1;
+        }
+    }
+    if (reserve_codec(codec, width, height, flags) != 0) return -1;
+
+    size -= KEYFRAME_HEADER_SIZE;
+    if (size > codec->payload_capacity || fread(codec->payload, 1, size, reader->file) != size) return -1;
+    grid_span_t all = {0, width * height};
+    if (decode_planes(codec, size, 0, next, &all, 1, width * height) != 0) return -1;
+
+    // Only the cells that differ from the frame on screen are reported
+    frame->clear = reader->clear_next || !same_layout(next, &reader->grid);
+    frame->n_spans = frame->clear ? full_rows(width, height, codec->runs) : diff_runs(next, &reader->grid, codec->runs);
+    ascii_grid_t shown = reader->grid;
+    reader->grid = *next;
+    *next = shown;
+    return 0;
+}
+
+static int read_delta(asciivideo_reader_t* reader, size_t size, asciivideo_frame_t* frame) {
+    codec_t* codec = &reader->codec;
+    ascii_grid_t* grid = &reader->grid;
+    if (!grid->chars || size > codec->payload_capacity || fread(codec->payload, 1, size, reader->file) != size) {
+        return -1;
+    }
+
+    size_t n_cells = grid->width * grid->height;
+    size_t pos = 0, end = 0, n_values = 0;
+    uint64_t n_runs;
+    if (get_varint(codec->payload, size, &pos, &n_runs) != 0 || n_runs > max_runs(grid->width, grid->height)) {
+        return -1;
+    }
+    for (size_t r = 0; r < n_runs; r++) {
+        uint64_t gap, length;
+        if (get_varint(codec->payload, size, &pos, &gap) != 0 || get_varint(codec->payload, size, &pos, &length) != 0 ||
+            length == 0 || gap > n_cells - end || length > n_cells - end - gap) {
+            return -1;
+        }
+        size_t start = end + (size_t) gap;
+        end = start + (size_t) length;
+        if (start / grid->width != (end - 1) / grid->width) return -1; // Runs stay within a row
+        codec->runs[r] = (grid_span_t) {start, (size_t) length};
+        n_values += (size_t) length;
+    }
+    if (n_runs > 0 && decode_planes(codec, size, pos, grid, codec->runs, (size_t) n_runs, n_values) != 0) return -1;
+    if (n_runs == 0 && pos != size) return -1;
+
+    frame->clear = reader->clear_next;
+    frame->n_spans = frame->clear ? full_rows(grid->width, grid->height, codec->runs) : (size_t) n_runs;
+    return 0;
+}
+
+int asciivideo_read_frame(asciivideo_reader_t* reader, asciivideo_frame_t* frame) {
+    uint8_t record[RECORD_HEADER_SIZE];
+    size_t got = fread(record, 1, RECORD_HEADER_SIZE, reader->file);
+    if (got == 0 && feof(reader->file)) return 1;
+
+    int status = -1;
+    if (got == RECORD_HEADER_SIZE) {
+        size_t size = get_u32(record + 1);
+        frame->keyframe = record[0] == RECORD_KEYFRAME;
+        if (record[0] == RECORD_KEYFRAME) status = read_keyframe(reader, size, frame);
+        else if (record[0] == RECORD_DELTA) status = read_delta(reader, size, frame);
+    }
+    if (status != 0) {
+        fprintf(stderr, "Error: Corrupt or truncated ASCII video file!\n");
+        return -1;
+    }
+
+    frame->grid = &reader->grid;
+    frame->spans = reader->codec.runs;
+    reader->clear_next = 0;
+    return 0;
+}
+
+int asciivideo_reader_seek(asciivideo_reader_t* reader, uint64_t index) {
+    // Walk the record headers from the start, remembering the last keyframe
+    if (fseeko(reader->file, HEADER_SIZE, SEEK_SET) != 0) return -1;
+    off_t keyframe_offset = -1;
+    uint64_t keyframe_index = 0;
+    for (uint64_t i = 0; i <= index; i++) {
+        off_t offset = ftello(reader->file);
+        uint8_t record[RECORD_HEADER_SIZE];
+        if (fread(record, 1, RECORD_HEADER_SIZE, reader->file) != RECORD_HEADER_SIZE) return -1;
+        if (record[0] == RECORD_KEYFRAME) {
+            keyframe_offset = offset;
+            keyframe_index = i;
+        }
+        if (fseeko(reader->file, (off_t) get_u32(record + 1), SEEK_CUR) != 0) return -1;
+    }
+    if (keyframe_offset < 0 || fseeko(reader->file, keyframe_offset, SEEK_SET) != 0) return -1;
+
+    // Decode up to the frame before `index`
+    asciivideo_frame_t frame;
+    for (uint64_t i = keyframe_index; i < index; i++) {
+        if (asciivideo_read_frame(reader, &frame) != 0) return -1;
+    }
+    reader->clear_next = 1;
+    return 0;
+}
+
+void asciivideo_reader_close(asciivideo_reader_t* reader) {
+    if (!reader) return;
+    fclose(reader->file);
+    free_ascii_grid(&reader->grid);
+    free_ascii_grid(&reader->scratch);
+    free_codec(&reader->codec);
+    free(reader);
+}
@@ -0,0 +1,415 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "../include/asciiview.h"
+#include "../include/arena.h"
+#include "../include/process.h"
+#include "../include/print_image.h"
+#include "../include/export.h"
+#include "../include/threadpool.h"
+#include "../include/cpu_dispatch.h"
+#include "../include/sixel.h"
+#include "../include/palette.h"
+#include "../include/output_queue.h"
+
+struct asciiview_ctx {
+    pthread_mutex_t lock;
+    arena_t arena;            // Temporaries and grid of the current conversion
+    ascii_grid_t grid;        // Last converted grid (lives in the arena)
+    image_t input;            // Staging buffer for 8-bit input
+    size_t input_capacity;    // In doubles
+    export_state_t* export_state;
+    term_writer_t writer;     // Terminal output buffer, kept between frames
+    ascii_grid_t shown;       // Grid on screen after the last redraw (heap copy)
+    output_queue_t* output;   // Output thread, NULL when frames are written synchronously
+    int incremental;          // Conversions recompute only the cells that changed
+    frame_history_t history;  // Previous frame, for incremental conversions
+    uint8_t* input8;          // Incremental mode: last 8-bit frame as given, to compare the next one
+    size_t input8_capacity;
+    int input_is_rgb8;        // The staged frame came with a copy in input8
+    uint8_t* dirty_tiles;     // Tiles of the staging buffer changed by the last frame
+    size_t tiles_capacity;
+};
+
+void asciiview_set_threads(int n_threads) {
+    threadpool_set_threads(n_threads);
+}
+
+asciiview_ctx_t* asciiview_create(void) {
+    asciiview_ctx_t* ctx = calloc(1, sizeof(*ctx));
+    if (!ctx) return NULL;
+
+    if (pthread_mutex_init(&ctx->lock, NULL) != 0) {
+        free(ctx);
+        return NULL;
+    }
+    arena_init(&ctx->arena, 0);
+    term_writer_init(&ctx->writer, STDOUT_FILENO);
+    return ctx;
+}
+
+void asciiview_destroy(asciiview_ctx_t* ctx) {
+    if (!ctx) return;
+    arena_free(&ctx->arena);
+    free(ctx->input.data);
+    export_state_free(ctx->export_state);
+    output_queue_destroy(ctx->output);
+    term_writer_free(&ctx->writer);
+    free_ascii_grid(&ctx->shown);
+    frame_history_free(&ctx->history);
+    free(ctx->input8);
+    free(ctx->dirty_tiles);
+    pthread_mutex_destroy(&ctx->lock);
+    free(ctx);
+}
+
+// Must be called with the lock held
+static ascii_grid_t convert_locked(asciiview_ctx_t* ctx, image_t* pixels, export_options_t* options) {
+    arena_reset(&ctx->arena);
+    ctx->grid = process_image_to_grid(pixels, options, &ctx->arena);
+    return ctx->grid;
+}
+
+// Grows the staging buffer only when a larger frame arrives. Called with the lock held.
+static int reserve_input(asciiview_ctx_t* ctx, size_t total_size) {
+    if (total_size > ctx->input_capacity) {
+        double* data = realloc(ctx->input.data, total_size * sizeof(*data));
+        if (!data) {
+            fprintf(stderr, "Error: Failed to allocate memory for image data!\n");
+            return -1;
+        }
+        ctx->input.data = data;
+        ctx->input.width = ctx->input.height = ctx->input.channels = 0; // Contents no longer a frame
+        ctx->input_capacity = total_size;
+    }
+    return 0;
+}
+
+// Tiles buffer for a width x height frame (zeroed), NULL on allocation failure
+static uint8_t* reserve_tiles(asciiview_ctx_t* ctx, size_t width, size_t height) {
+    size_t n_tiles = ((width + DIRTY_TILE_SIZE - 1) / DIRTY_TILE_SIZE) * ((height + DIRTY_TILE_SIZE - 1) / DIRTY_TILE_SIZE);
+    if (n_tiles > ctx->tiles_capacity) {
+        uint8_t* tiles = realloc(ctx->dirty_tiles, n_tiles);
+        if (!tiles) return NULL;
+        ctx->dirty_tiles = tiles;
+        ctx->tiles_capacity = n_tiles;
+    }
+    memset(ctx->dirty_tiles, 0, n_tiles);
+    return ctx->dirty_tiles;
+}
+
+// Copies a frame into the staging buffer. In incremental mode, when the staged frame
+// has the same size and format, only the tile-wide row spans that differ are copied
+// and the tiles they belong to are returned; NULL means the whole frame was copied.
+// 8-bit frames are compared with a copy of the previous 8-bit frame, so unchanged
+// spans are not converted at all. Called with the lock held.
+static const uint8_t* stage_input(asciiview_ctx_t* ctx, const uint8_t* pixels8, const double* pixels,
+                                  size_t width, size_t height, size_t channels) {
+    double* data = ctx->input.data;
+    size_t total_size = width * height * channels;
+    int same_frame = ctx->input.width == width && ctx->input.height == height &&
+                     ctx->input.channels == channels && ctx->input_is_rgb8 == (pixels8 != NULL);
+    uint8_t* tiles = NULL;
+
+    if (ctx->incremental && pixels8 && total_size > ctx->input8_capacity) {
+        uint8_t* input8 = realloc(ctx->input8, total_size);
+        if (input8) {
+            ctx->input8 = input8;
+            ctx->input8_capacity = total_size;
+        }
+    }
+    int keep8 = ctx->incremental && pixels8 && total_size <= ctx->input8_capacity;
+    if (ctx->incremental && same_frame && (keep8 || !pixels8)) tiles = reserve_tiles(ctx, width, height);
+
+    ctx->input.width = width;
+    ctx->input.height = height;
+    ctx->input.channels = channels;
+    ctx->input_is_rgb8 = keep8;
+
+    if (!tiles) {
+        if (pixels8) {
+            for (size_t i = 0; i < total_size; i++) data[i] = pixels8[i] / 255.0;
+            if (keep8) memcpy(ctx->input8, pixels8, total_size);
+        } else {
+            memcpy(data, pixels, total_size * sizeof(*data));
+        }
+        return NULL;
+    }
+
+    size_t tiles_x = (width + DIRTY_TILE_SIZE - 1) / DIRTY_TILE_SIZE;
+    size_t span = DIRTY_TILE_SIZE * channels;
+    for (size_t y = 0; y < height; y++) {
+        uint8_t* tile_row = &tiles[(y / DIRTY_TILE_SIZE) * tiles_x];
+        size_t row = y * width * channels;
+        for (size_t tx = 0; tx < tiles_x; tx++) {
+            size_t begin = row + tx * span;
+            size_t length = (tx + 1 == tiles_x) ? row + width * channels - begin : span;
+            if (pixels8) {
+                if (memcmp(&ctx->input8[begin], &pixels8[begin], length) == 0) continue;
+                memcpy(&ctx->input8[begin], &pixels8[begin], length);
+                for (size_t k = begin; k < begin + length; k++) data[k] = pixels8[k] / 255.0;
+            } else {
+                if (memcmp(&data[begin], &pixels[begin], length * sizeof(*data)) == 0) continue;
+                memcpy(&data[begin], &pixels[begin], length * sizeof(*data));
+            }
+            tile_row[tx] = 1;
+        }
+    }
+    return tiles;
+}
+
+// Converts the staged frame incrementally. Called with the lock held.
+static ascii_grid_t convert_staged_locked(asciiview_ctx_t* ctx, const uint8_t* dirty_tiles, export_options_t* options) {
+    arena_reset(&ctx->arena);
+    ctx->grid = process_image_incremental(&ctx->input, dirty_tiles, options, &ctx->history);
+    return ctx->grid;
+}
+
+ascii_grid_t asciiview_convert(asciiview_ctx_t* ctx, image_t* pixels, export_options_t* options) {
+    if (!ctx || !pixels || !options) return (ascii_grid_t) {0};
+
+    pthread_mutex_lock(&ctx->lock);
+    ascii_grid_t grid = {0};
+    if (!ctx->incremental) {
+        grid = convert_locked(ctx, pixels, options);
+    } else if (pixels->data && reserve_input(ctx, pixels->width * pixels->height * pixels->channels) == 0) {
+        const uint8_t* dirty_tiles = stage_input(ctx, NULL, pixels->data, pixels->width, pixels->height, pixels->channels);
+        grid = convert_staged_locked(ctx, dirty_tiles, options);
+    }
+    pthread_mutex_unlock(&ctx->lock);
+    return grid;
+}
+
+ascii_grid_t asciiview_convert_rgb8(asciiview_ctx_t* ctx, const uint8_t* pixels, size_t width,
+                                    size_t height, size_t channels, export_options_t* options) {
+    if (!ctx || !pixels || !options || channels < 1 || channels > 4) return (ascii_grid_t) {0};
+    // The frame is staged as doubles: width * height * channels of them must fit in memory
+    if (width == 0 || height == 0 || width > SIZE_MAX / sizeof(double) / channels / height) {
+        fprintf(stderr, "Error: Invalid frame size %zux%zu!\n", width, height);
+        return (ascii_grid_t) {0};
+    }
+
+    pthread_mutex_lock(&ctx->lock);
+    if (reserve_input(ctx, width * height * channels) != 0) {
+        pthread_mutex_unlock(&ctx->lock);
+        return (ascii_grid_t) {0};
+    }
+
+    const uint8_t* dirty_tiles = stage_input(ctx, pixels, NULL, width, height, channels);
+    ascii_grid_t grid = ctx->incremental ? convert_staged_locked(ctx, dirty_tiles, options)
+                                         : convert_locked(ctx, &ctx->input, options);
+    pthread_mutex_unlock(&ctx->lock);
+    return grid;
+}
+
+void asciiview_set_incremental(asciiview_ctx_t* ctx, int enabled) {
+    if (!ctx) return;
+
+    pthread_mutex_lock(&ctx->lock);
+    // The next conversion starts from scratch either way
+    if (ctx->grid.chars == ctx->history.grid.chars) ctx->grid = (ascii_grid_t) {0};
+    frame_history_free(&ctx->history);
+    ctx->input.width = ctx->input.height = ctx->input.channels = 0;
+    ctx->incremental = enabled != 0;
+    pthread_mutex_unlock(&ctx->lock);
+}
+
+int asciiview_set_async_output(asciiview_ctx_t* ctx, size_t n_buffers) {
+    if (!ctx) return -1;
+
+    pthread_mutex_lock(&ctx->lock);
+    output_queue_destroy(ctx->output); // Writes out anything still queued
+    ctx->output = NULL;
+    int status = 0;
+    if (n_buffers > 0) {
+        ctx->output = output_queue_create(STDOUT_FILENO, n_buffers);
+        if (!ctx->output) status = -1;
+    }
+    pthread_mutex_unlock(&ctx->lock);
+    return status;
+}
+
+int asciiview_flush_output(asciiview_ctx_t* ctx) {
+    if (!ctx) return -1;
+
+    pthread_mutex_lock(&ctx->lock);
+    int status = ctx->output ? output_queue_drain(ctx->output) : 0;
+    pthread_mutex_unlock(&ctx->lock);
+    return status;
+}
+
+// Buffer for the next frame: a free frame buffer of the output thread, if enabled
+// (may wait for one), the context's own writer otherwise. Called with the lock held.
+static term_writer_t* begin_frame(asciiview_ctx_t* ctx) {
+    fflush(stdout);
+    return ctx->output ? output_queue_acquire(ctx->output) : &ctx->writer;
+}
+
+// Queues the frame, or writes it right away without an output thread
+static int end_frame(asciiview_ctx_t* ctx, term_writer_t* writer) {
+    if (ctx->output) {
+        output_queue_submit(ctx->output, writer);
+        return 0;
+    }
+    return term_writer_flush(writer);
+}
+
+// Must be called with the lock held
+static void print_locked(asciiview_ctx_t* ctx, ascii_grid_t* grid, const export_options_t* options) {
+    term_writer_t* writer = begin_frame(ctx);
+    if (render_image(grid, options, writer) != 0) writer->length = 0;
+    end_frame(ctx, writer);
+}
+
+void asciiview_print(asciiview_ctx_t* ctx, const export_options_t* options) {
+    if (!ctx) return;
+
+    pthread_mutex_lock(&ctx->lock);
+    print_locked(ctx, &ctx->grid, options);
+    pthread_mutex_unlock(&ctx->lock);
+}
+
+void asciiview_print_grid(asciiview_ctx_t* ctx, ascii_grid_t* grid, const export_options_t* options) {
+    if (!ctx || !grid) return;
+
+    pthread_mutex_lock(&ctx->lock);
+    print_locked(ctx, grid, options);
+    pthread_mutex_unlock(&ctx->lock);
+}
+
+int asciiview_print_sixel(asciiview_ctx_t* ctx, image_t* pixels, const export_options_t* options) {
+    if (!ctx || !pixels || !options) return -1;
+
+    pthread_mutex_lock(&ctx->lock);
+    size_t max_width = ctx->grid.width * (size_t) options->cell_pixel_width;
+    size_t max_height = ctx->grid.height * (size_t) options->cell_pixel_height;
+    size_t max_colors = options->palette_size > 0 ? (size_t) options->palette_size : PALETTE_MAX_COLORS;
+
+    // Temporaries go to the arena after the grid, which stays valid.
+    // The encoder flushes as it goes: queued frames must be out first.
+    if (ctx->output) output_queue_drain(ctx->output);
+    fflush(stdout);
+    int status = sixel_write(pixels, max_width, max_height, max_colors, &ctx->writer, &ctx->arena);
+    if (term_writer_flush(&ctx->writer) != 0) status = -1;
+    pthread_mutex_unlock(&ctx->lock);
+    return status;
+}
+
+// Must be called with the lock held
+static void redraw_locked(asciiview_ctx_t* ctx, ascii_grid_t* grid, const export_options_t* options) {
+    term_writer_t* writer = begin_frame(ctx);
+    int status = render_image_diff(grid, ctx->shown.chars ? &ctx->shown : NULL, options, writer);
+    if (status != 0) writer->length = 0;
+    if (end_frame(ctx, writer) == 0 && status == 0) {
+        if (copy_ascii_grid(&ctx->shown, grid) != 0) {
+            free_ascii_grid(&ctx->shown); // Next redraw sends the full frame
+        }
+    }
+}
+
+void asciiview_redraw(asciiview_ctx_t* ctx, const export_options_t* options) {
+    if (!ctx) return;
+
+    pthread_mutex_lock(&ctx->lock);
+    redraw_locked(ctx, &ctx->grid, options);
+    pthread_mutex_unlock(&ctx->lock);
+}
+
+void asciiview_redraw_grid(asciiview_ctx_t* ctx, ascii_grid_t* grid, const export_options_t* options) {
+    if (!ctx || !grid) return;
+
+    pthread_mutex_lock(&ctx->lock);
+    redraw_locked(ctx, grid, options);
+    pthread_mutex_unlock(&ctx->lock);
+}
+
+void asciiview_draw_spans(asciiview_ctx_t* ctx, const ascii_grid_t* grid, const grid_span_t* spans, size_t n_spans,
+                          int clear, const export_options_t* options) {
+    if (!ctx || !grid) return;
+
+    pthread_mutex_lock(&ctx->lock);
+    term_writer_t* writer = begin_frame(ctx);
+    if (render_image_spans(grid, spans, n_spans, clear, options, writer) != 0) writer->length = 0;
+    end_frame(ctx, writer);
+    free_ascii_grid(&ctx->shown); // The screen no longer matches it
+    pthread_mutex_unlock(&ctx->lock);
+}
+
+size_t asciiview_frame_size(asciiview_ctx_t* ctx, const export_options_t* options, int redraw) {
+    if (!ctx) return 0;
+
+    pthread_mutex_lock(&ctx->lock);
+    // Formatted into the context's own writer, which is empty between frames
+    term_writer_t* scratch = &ctx->writer;
+    size_t start = scratch->length;
+    int status = redraw ? render_image_diff(&ctx->grid, ctx->shown.chars ? &ctx->shown : NULL, options, scratch)
+                        : render_image(&ctx->grid, options, scratch);
+    size_t size = (status == 0) ? scratch->length - start : 0;
+    scratch->length = start;
+    pthread_mutex_unlock(&ctx->lock);
+    return size;
+}
+
+void asciiview_output_totals(asciiview_ctx_t* ctx, size_t* bytes, double* seconds) {
+    if (!ctx) return;
+
+    pthread_mutex_lock(&ctx->lock);
+    *bytes = ctx->writer.bytes_written;
+    *seconds = ctx->writer.write_seconds;
+    if (ctx->output) {
+        *bytes += output_queue_bytes_written(ctx->output);
+        *seconds += output_queue_write_seconds(ctx->output);
+    }
+    pthread_mutex_unlock(&ctx->lock);
+}
+
+// Must be called with the lock held
+static int export_locked(asciiview_ctx_t* ctx, ascii_grid_t* grid, export_options_t* options) {
+    if (!ctx->export_state) ctx->export_state = export_state_create();
+    if (!ctx->export_state || !grid->chars) return -1;
+    return export_ascii_with_state(ctx->export_state, grid, options);
+}
+
+int asciiview_export(asciiview_ctx_t* ctx, export_options_t* options) {
+    if (!ctx || !options) return -1;
+
+    pthread_mutex_lock(&ctx->lock);
+    int status = export_locked(ctx, &ctx->grid, options);
+    pthread_mutex_unlock(&ctx->lock);
+    return status;
+}
+
+int asciiview_export_grid(asciiview_ctx_t* ctx, ascii_grid_t* grid, export_options_t* options) {
+    if (!ctx || !grid || !options) return -1;
+
+    pthread_mutex_lock(&ctx->lock);
+    int status = export_locked(ctx, grid, options);
+    pthread_mutex_unlock(&ctx->lock);
+    return status;
+}
+
+void asciiview_print_stats(asciiview_ctx_t* ctx, FILE* out) {
+    if (!ctx) return;
+
+    pthread_mutex_lock(&ctx->lock);
+    arena_print_stats(&ctx->arena, out);
+    size_t bytes_written = ctx->writer.bytes_written;
+    if (ctx->output) {
+        bytes_written += output_queue_bytes_written(ctx->output);
+        fprintf(out, "Output thread: %zu waits for a free frame buffer\n", output_queue_stalls(ctx->output));
+    }
+    fprintf(out, "Terminal: %zu bytes written\n", bytes_written);
+    if (ctx->history.cells_total > 0) {
+        fprintf(out, "Incremental: %zu of %zu cells recomputed (%.1f%%)\n", ctx->history.cells_recomputed,
+                ctx->history.cells_total, 100.0 * ctx->history.cells_recomputed / ctx->history.cells_total);
+    }
+    pthread_mutex_unlock(&ctx->lock);
+}
+
+const char* asciiview_cpu_path(void) {
+    return cpu_dispatch_path();
+}
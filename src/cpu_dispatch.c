@@ -0,0 +1,13 @@
+#include "../include/cpu_dispatch.h"
+
+// Mirrors the resolver priority used for HOT_KERNEL clones
+const char* cpu_dispatch_path(void) {
+#if HAVE_CPU_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return "avx512f";
+    if (__builtin_cpu_supports("avx2")) return "avx2";
+    return "sse2";
+#else
+    return "generic";
+#endif
+}
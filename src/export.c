@@ -5,29 +5,84 @@
 #include <pango/pangocairo.h>
 #include "export.h"
 #include "image.h"
+#include "threadpool.h"
 
-void export_ascii_to_image(ascii_grid_t* grid, export_options_t* options) {
-    if (!grid || !options || !options->output_path) return;
+// Grid rows per rendering band when exporting on several threads
+#define BAND_ROWS 16
+// Entries of the glyph atlas: one per byte value of grid->chars
+#define ATLAS_GLYPHS 256
 
-    printf("Preparazione export immagine: %s\n", options->output_path);
+// Coverage of one character drawn in a cell, trimmed to its ink. The offsets place
+// the mask relative to the cell's top-left corner and already include the centering,
+// so the mask may start above or left of the cell.
+typedef struct {
+    int ready;
+    int off_x, off_y;
+    int width, height;
+    size_t offset;      // Start of the mask in atlas_pixels (width * height bytes)
+} atlas_glyph_t;
 
-    // --- Configurazione Font & Dimensioni Cella ---
-    cairo_surface_t* temp_surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, 10, 10);
-    cairo_t* temp_cr = cairo_create(temp_surface);
+// Font, surface and glyph atlas kept between exports: only rebuilt when the font,
+// the cell size or the output size changes
+struct export_state {
+    char* font_family;
+    double font_cell_h;
+    PangoFontDescription* desc;
 
-    PangoLayout* layout = pango_cairo_create_layout(temp_cr);
-    PangoFontDescription* desc = pango_font_description_new();
-    
-    const char* font_family = options->font_family ? options->font_family : "DejaVu Sans Mono";
-    pango_font_description_set_family(desc, font_family);
-    
-    // Use calculated cell dimensions from process.c
-    double cell_w = (double)options->cell_pixel_width;
-    double cell_h = (double)options->cell_pixel_height;
-    
-    // Safety check
-    if (cell_w < 1.0) cell_w = 1.0;
-    if (cell_h < 1.0) cell_h = 1.0;
+    int surface_w;
+    int surface_h;
+    cairo_surface_t* surface;
+    cairo_t* cr;
+
+    // A8 masks of the characters rendered so far at atlas_cell_w x font_cell_h
+    double atlas_cell_w;
+    atlas_glyph_t atlas[ATLAS_GLYPHS];
+    uint8_t* atlas_pixels;
+    size_t atlas_size, atlas_capacity;
+};
+
+export_state_t* export_state_create(void) {
+    return calloc(1, sizeof(export_state_t));
+}
+
+static void release_surface(export_state_t* state) {
+    if (state->cr) cairo_destroy(state->cr);
+    if (state->surface) cairo_surface_destroy(state->surface);
+    state->cr = NULL;
+    state->surface = NULL;
+    state->surface_w = state->surface_h = 0;
+}
+
+static void reset_atlas(export_state_t* state) {
+    memset(state->atlas, 0, sizeof(state->atlas));
+    state->atlas_size = 0;
+    state->atlas_cell_w = 0.0;
+}
+
+void export_state_free(export_state_t* state) {
+    if (!state) return;
+    release_surface(state);
+    free(state->atlas_pixels);
+    if (state->desc) pango_font_description_free(state->desc);
+    free(state->font_family);
+    free(state);
+}
+
+// --- Configurazione Font ---
+static int prepare_font(export_state_t* state, const char* font_family, double cell_h) {
+    if (state->desc && state->font_cell_h == cell_h && strcmp(state->font_family, font_family) == 0) {
+        return 0;
+    }
+
+    if (state->desc) pango_font_description_free(state->desc);
+    free(state->font_family);
+
+    state->desc = pango_font_description_new();
+    state->font_family = strdup(font_family);
+    state->font_cell_h = cell_h;
+    if (!state->desc || !state->font_family) return -1;
+
+    pango_font_description_set_family(state->desc, font_family);
 
     // Calculate font size to fit height
     // Pango size is in Pango units (1/1024 of a point)
@@ -37,17 +92,339 @@ void export_ascii_to_image(ascii_grid_t* grid, export_options_t* options) {
     // Height in pixels = Points * (96/72) * (PangoScale/1024)? No.
     // Simplest: pango_font_description_set_absolute_size sets size in Pango units (scaled).
     // If we want 'cell_h' pixels, we set size to cell_h * PANGO_SCALE.
-    pango_font_description_set_absolute_size(desc, cell_h * PANGO_SCALE);
-    
-    pango_layout_set_font_description(layout, desc);
-    
-    // Cleanup temp
+    pango_font_description_set_absolute_size(state->desc, cell_h * PANGO_SCALE);
+
+    reset_atlas(state);
+    return 0;
+}
+
+// --- Creazione Superficie Reale ---
+static int prepare_surface(export_state_t* state, int img_w, int img_h) {
+    if (state->surface && state->surface_w == img_w && state->surface_h == img_h) {
+        return 0;
+    }
+
+    release_surface(state);
+    state->surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, img_w, img_h);
+    if (cairo_surface_status(state->surface) != CAIRO_STATUS_SUCCESS) {
+        fprintf(stderr, "Errore creazione superficie Cairo: %s\n",
+                cairo_status_to_string(cairo_surface_status(state->surface)));
+        release_surface(state);
+        return -1;
+    }
+    state->cr = cairo_create(state->surface);
+    state->surface_w = img_w;
+    state->surface_h = img_h;
+    return 0;
+}
+
+// Half blocks and braille dots are drawn as rectangles: they fill exactly their
+// share of the cell whatever the font, and never spill into neighbouring rows
+static void draw_glyph_rows(cairo_t* cr, ascii_grid_t* grid, double cell_w, double cell_h,
+                            size_t row_begin, size_t row_end, double offset_y) {
+    for (size_t y = row_begin; y < row_end; y++) {
+        double cell_y = y * cell_h - offset_y;
+        for (size_t x = 0; x < grid->width; x++) {
+            size_t idx = y * grid->width + x;
+            double cell_x = x * cell_w;
+            uint32_t glyph = grid->glyphs[idx];
+
+            if (grid->bg_r) {
+                cairo_set_source_rgb(cr, grid->bg_r[idx] / 255.0, grid->bg_g[idx] / 255.0, grid->bg_b[idx] / 255.0);
+                cairo_rectangle(cr, cell_x, cell_y, cell_w, cell_h);
+                cairo_fill(cr);
+            }
+            cairo_set_source_rgb(cr, grid->r[idx] / 255.0, grid->g[idx] / 255.0, grid->b[idx] / 255.0);
+
+            if (glyph == 0x2580) {
+                // Upper half block
+                cairo_rectangle(cr, cell_x, cell_y, cell_w, cell_h / 2.0);
+                cairo_fill(cr);
+            } else if (glyph >= 0x2800 && glyph <= 0x28FF) {
+                // Braille: bits 0-2 and 6 are the left column, 3-5 and 7 the right one
+                static const int dot_x[8] = {0, 0, 0, 1, 1, 1, 0, 1};
+                static const int dot_y[8] = {0, 1, 2, 0, 1, 2, 3, 3};
+                double dot_w = cell_w / 2.0;
+                double dot_h = cell_h / 4.0;
+                for (int bit = 0; bit < 8; bit++) {
+                    if (!(glyph & (1u << bit))) continue;
+                    cairo_rectangle(cr, cell_x + dot_x[bit] * dot_w + dot_w * 0.2, cell_y + dot_y[bit] * dot_h + dot_h * 0.2,
+                                    dot_w * 0.6, dot_h * 0.6);
+                }
+                cairo_fill(cr);
+            }
+        }
+    }
+}
+
+// --- Atlante dei glifi ---
+// Shaping and rasterizing a character is by far the costliest part of drawing a cell,
+// and a grid only uses a handful of distinct characters. Each one is rendered once,
+// with Pango, into an A8 surface at the same sub-pixel position it takes in its cell
+// (centered as the layout measures it); cells then tint its coverage into the output.
+
+// Renders `c` into its atlas entry. Returns 0 on success, -1 on allocation failure.
+static int render_atlas_glyph(export_state_t* state, unsigned char c, double cell_w, double cell_h) {
+    atlas_glyph_t* glyph = &state->atlas[c];
+
+    // Room around the cell for ink that spills out of it (line box taller than the
+    // cell, glyphs wider than it, overhangs)
+    int pad = 2 * (int) cell_h + 2;
+    int surface_w = (int) cell_w + 2 * pad;
+    int surface_h = (int) cell_h + 2 * pad;
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_A8, surface_w, surface_h);
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(surface);
+        return -1;
+    }
+    cairo_t* cr = cairo_create(surface);
+    PangoLayout* layout = pango_cairo_create_layout(cr);
+    pango_layout_set_font_description(layout, state->desc);
+    char str[2] = {(char) c, '\0'};
+    pango_layout_set_text(layout, str, -1);
+
+    // Centered in the cell as measured by the layout, at the same sub-pixel offset
+    int char_pixel_w, char_pixel_h;
+    pango_layout_get_pixel_size(layout, &char_pixel_w, &char_pixel_h);
+    cairo_set_source_rgb(cr, 0.0, 0.0, 0.0);
+    cairo_move_to(cr, pad + (cell_w - char_pixel_w) / 2.0, pad + (cell_h - char_pixel_h) / 2.0);
+    pango_cairo_show_layout(cr, layout);
+    cairo_surface_flush(surface);
+
+    // Trim to the covered pixels
+    const unsigned char* data = cairo_image_surface_get_data(surface);
+    int stride = cairo_image_surface_get_stride(surface);
+    int x0 = surface_w, y0 = surface_h, x1 = 0, y1 = 0;
+    for (int y = 0; y < surface_h; y++) {
+        for (int x = 0; x < surface_w; x++) {
+            if (!data[(size_t) y * stride + x]) continue;
+            if (x < x0) x0 = x;
+            if (x >= x1) x1 = x + 1;
+            if (y < y0) y0 = y;
+            if (y >= y1) y1 = y + 1;
+        }
+    }
+
+    int status = 0;
+    *glyph = (atlas_glyph_t) {1, 0, 0, 0, 0, 0};
+    if (x1 > x0) {
+        size_t size = (size_t) (x1 - x0) * (size_t) (y1 - y0);
+        if (state->atlas_size + size > state->atlas_capacity) {
+            size_t capacity = state->atlas_capacity ? state->atlas_capacity : 4096;
+            while (capacity < state->atlas_size + size) capacity *= 2;
+            uint8_t* pixels = realloc(state->atlas_pixels, capacity);
+            if (pixels) {
+                state->atlas_pixels = pixels;
+                state->atlas_capacity = capacity;
+            }
+        }
+        if (state->atlas_size + size <= state->atlas_capacity) {
+            *glyph = (atlas_glyph_t) {1, x0 - pad, y0 - pad, x1 - x0, y1 - y0, state->atlas_size};
+            for (int y = y0; y < y1; y++) {
+                memcpy(&state->atlas_pixels[state->atlas_size], &data[(size_t) y * stride + x0], (size_t) (x1 - x0));
+                state->atlas_size += (size_t) (x1 - x0);
+            }
+        } else {
+            glyph->ready = 0;
+            status = -1;
+        }
+    }
+
     g_object_unref(layout);
-    cairo_destroy(temp_cr);
-    cairo_surface_destroy(temp_surface);
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    return status;
+}
+
+// Makes sure every character of the grid is in the atlas
+static int prepare_atlas(export_state_t* state, const ascii_grid_t* grid, double cell_w, double cell_h) {
+    if (state->atlas_cell_w != cell_w) {
+        reset_atlas(state);
+        state->atlas_cell_w = cell_w;
+    }
 
+    int used[ATLAS_GLYPHS] = {0};
+    size_t n_cells = grid->width * grid->height;
+    for (size_t i = 0; i < n_cells; i++) {
+        used[(unsigned char) grid->chars[i]] = 1;
+    }
+    for (int c = 0; c < ATLAS_GLYPHS; c++) {
+        if (used[c] && !state->atlas[c].ready && render_atlas_glyph(state, (unsigned char) c, cell_w, cell_h) != 0) {
+            fprintf(stderr, "Error: Failed to allocate memory for the glyph atlas!\n");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// x * y / 255, rounded as pixman does it
+static inline uint32_t mul_un8(uint32_t x, uint32_t y) {
+    uint32_t t = x * y + 0x80;
+    return (t + (t >> 8)) >> 8;
+}
+
+// Tints the atlas masks of grid rows [row_begin, row_end) into the surface pixel rows
+// [py0, py1), cell after cell as Cairo composites text (OVER with an opaque color)
+static void composite_rows(const export_state_t* state, const ascii_grid_t* grid, int cell_w, int cell_h,
+                           size_t row_begin, size_t row_end, int py0, int py1) {
+    unsigned char* pixels = cairo_image_surface_get_data(state->surface);
+    int stride = cairo_image_surface_get_stride(state->surface);
+    int img_w = state->surface_w;
+
+    for (size_t y = row_begin; y < row_end; y++) {
+        for (size_t x = 0; x < grid->width; x++) {
+            size_t idx = y * grid->width + x;
+            const atlas_glyph_t* glyph = &state->atlas[(unsigned char) grid->chars[idx]];
+            if (glyph->width == 0) continue;
+
+            int left = (int) x * cell_w + glyph->off_x;
+            int top = (int) y * cell_h + glyph->off_y;
+            int gx0 = left < 0 ? -left : 0;
+            int gx1 = (left + glyph->width > img_w) ? img_w - left : glyph->width;
+            int gy0 = top < py0 ? py0 - top : 0;
+            int gy1 = (top + glyph->height > py1) ? py1 - top : glyph->height;
+            if (gx0 >= gx1 || gy0 >= gy1) continue;
+
+            uint32_t r = grid->r[idx], g = grid->g[idx], b = grid->b[idx];
+            for (int gy = gy0; gy < gy1; gy++) {
+                const uint8_t* mask = &state->atlas_pixels[glyph->offset + (size_t) gy * glyph->width];
+                uint32_t* row = (uint32_t*) (pixels + (size_t) (top + gy) * stride);
+                for (int gx = gx0; gx < gx1; gx++) {
+                    uint32_t m = mask[gx];
+                    if (!m) continue;
+                    uint32_t dst = row[left + gx];
+                    uint32_t inv = 255 - m;
+                    uint32_t out_r = mul_un8(r, m) + mul_un8((dst >> 16) & 0xff, inv);
+                    uint32_t out_g = mul_un8(g, m) + mul_un8((dst >> 8) & 0xff, inv);
+                    uint32_t out_b = mul_un8(b, m) + mul_un8(dst & 0xff, inv);
+                    row[left + gx] = 0xff000000u | (out_r << 16) | (out_g << 8) | out_b;
+                }
+            }
+        }
+    }
+}
+
+typedef struct {
+    const export_state_t* state;
+    const ascii_grid_t* grid;
+    int cell_w, cell_h;
+    int reach_up, reach_down;   // Pixels the masks extend above and below their cell
+    size_t n_bands;
+} composite_job_t;
+
+// Each band owns a slice of pixel rows and composites every cell whose mask reaches
+// into it, clipped to the slice: bands write disjoint memory, and each pixel sees
+// its cells in the same order as in a single pass
+static void composite_bands(void* arg, size_t band_begin, size_t band_end) {
+    composite_job_t* job = arg;
+    int img_h = job->state->surface_h;
+
+    for (size_t band = band_begin; band < band_end; band++) {
+        int py0 = (band == 0) ? 0 : (int) (band * BAND_ROWS) * job->cell_h;
+        int py1 = (band + 1 == job->n_bands) ? img_h : (int) ((band + 1) * BAND_ROWS) * job->cell_h;
+        if (py1 > img_h) py1 = img_h;
+        if (py0 >= py1) continue;
+
+        int first = (py0 - job->reach_down) / job->cell_h - 1;
+        size_t row_begin = first > 0 ? (size_t) first : 0;
+        size_t row_end = (size_t) ((py1 + job->reach_up) / job->cell_h) + 1;
+        if (row_end > job->grid->height) row_end = job->grid->height;
+        composite_rows(job->state, job->grid, job->cell_w, job->cell_h, row_begin, row_end, py0, py1);
+    }
+}
+
+// --- Rendering a bande in parallelo (glifi a blocchi) ---
+// Each band renders into a private surface that also covers `margin_rows` grid rows
+// above and below it, drawing those rows too: glyphs that spill across the band edge
+// land exactly as in a single top-to-bottom pass. Only the band's own pixel rows are
+// copied back, so tasks never write to the same memory. A band whose private
+// surface cannot be created is left out and flagged in `failed`.
+typedef struct {
+    export_state_t* state;
+    ascii_grid_t* grid;
+    export_options_t* options;
+    double cell_w, cell_h;
+    size_t margin_rows;
+    size_t n_bands;
+    int failed;             // Set (atomically) when a band could not be rendered
+} band_job_t;
+
+static void render_bands(void* arg, size_t band_begin, size_t band_end) {
+    band_job_t* job = arg;
+    ascii_grid_t* grid = job->grid;
+    int img_w = job->state->surface_w;
+    int img_h = job->state->surface_h;
+
+    for (size_t band = band_begin; band < band_end; band++) {
+        size_t row_begin = band * BAND_ROWS;
+        size_t row_end = (row_begin + BAND_ROWS < grid->height) ? row_begin + BAND_ROWS : grid->height;
+
+        // Pixel rows owned by this band; the last one also owns any padding below the grid
+        int py0 = (band == 0) ? 0 : (int)(row_begin * job->cell_h);
+        int py1 = (band + 1 == job->n_bands) ? img_h : (int)(row_end * job->cell_h);
+        if (py1 > img_h) py1 = img_h;
+        if (py0 >= py1) continue;
+
+        int margin_px = (int)(job->margin_rows * job->cell_h) + 1;
+        int top = (py0 > margin_px) ? py0 - margin_px : 0;
+        int bottom = (py1 + margin_px < img_h) ? py1 + margin_px : img_h;
+
+        cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, img_w, bottom - top);
+        if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+            cairo_surface_destroy(surface);
+            __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+        cairo_t* cr = cairo_create(surface);
+        if (cairo_status(cr) != CAIRO_STATUS_SUCCESS) {
+            cairo_destroy(cr);
+            cairo_surface_destroy(surface);
+            __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        double bg = job->options->bg_is_white ? 1.0 : 0.0;
+        cairo_set_source_rgb(cr, bg, bg, bg);
+        cairo_paint(cr);
+
+        size_t draw_begin = (row_begin > job->margin_rows) ? row_begin - job->margin_rows : 0;
+        size_t draw_end = (row_end + job->margin_rows < grid->height) ? row_end + job->margin_rows : grid->height;
+        draw_glyph_rows(cr, grid, job->cell_w, job->cell_h, draw_begin, draw_end, top);
+        cairo_surface_flush(surface);
+
+        // Copy the owned rows into the shared surface
+        unsigned char* src = cairo_image_surface_get_data(surface);
+        int src_stride = cairo_image_surface_get_stride(surface);
+        unsigned char* dst = cairo_image_surface_get_data(job->state->surface);
+        int dst_stride = cairo_image_surface_get_stride(job->state->surface);
+        for (int py = py0; py < py1; py++) {
+            memcpy(dst + (size_t) py * dst_stride, src + (size_t) (py - top) * src_stride, (size_t) img_w * 4);
+        }
+
+        cairo_destroy(cr);
+        cairo_surface_destroy(surface);
+    }
+}
+
+int export_ascii_with_state(export_state_t* state, ascii_grid_t* grid, export_options_t* options) {
+    if (!state || !grid || !options || !options->output_path) return -1;
+
+    printf("Preparazione export immagine: %s\n", options->output_path);
+
+    // Use calculated cell dimensions from process.c
+    double cell_w = (double)options->cell_pixel_width;
+    double cell_h = (double)options->cell_pixel_height;
+    
+    // Safety check
+    if (cell_w < 1.0) cell_w = 1.0;
+    if (cell_h < 1.0) cell_h = 1.0;
+
+    const char* font_family = options->font_family ? options->font_family : "DejaVu Sans Mono";
+    if (prepare_font(state, font_family, cell_h) != 0) {
+        fprintf(stderr, "Error: Failed to allocate font description!\n");
+        return -1;
+    }
 
-    // --- Creazione Superficie Reale ---
     int img_w = (int)(grid->width * cell_w);
     int img_h = (int)(grid->height * cell_h);
     
@@ -57,8 +434,8 @@ void export_ascii_to_image(ascii_grid_t* grid, export_options_t* options) {
         img_h = options->target_pixel_h;
     }
 
-    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, img_w, img_h);
-    cairo_t* cr = cairo_create(surface);
+    if (prepare_surface(state, img_w, img_h) != 0) return -1;
+    cairo_t* cr = state->cr;
 
     // Sfondo
     if (options->bg_is_white) {
@@ -69,40 +446,52 @@ void export_ascii_to_image(ascii_grid_t* grid, export_options_t* options) {
     cairo_paint(cr);
 
     // --- Disegno Griglia ---
-    layout = pango_cairo_create_layout(cr);
-    // Re-apply font settings to this context's layout
-    pango_layout_set_font_description(layout, desc);
+    size_t n_bands = (grid->height + BAND_ROWS - 1) / BAND_ROWS;
+    if (!grid->glyphs) {
+        if (prepare_atlas(state, grid, cell_w, cell_h) != 0) return -1;
 
-    for (size_t y = 0; y < grid->height; y++) {
-        for (size_t x = 0; x < grid->width; x++) {
-            ascii_cell_t cell = grid->cells[y * grid->width + x];
-            
-            double r = cell.r / 255.0;
-            double g = cell.g / 255.0;
-            double b = cell.b / 255.0;
-            cairo_set_source_rgb(cr, r, g, b);
-
-            char str[2] = {cell.character, '\0'};
-            pango_layout_set_text(layout, str, -1);
-
-            // Posizionamento (Centrato nella cella se possibile)
-            int char_pixel_w, char_pixel_h;
-            pango_layout_get_pixel_size(layout, &char_pixel_w, &char_pixel_h);
-            
-            double pos_x = x * cell_w + (cell_w - char_pixel_w) / 2.0;
-            double pos_y = y * cell_h + (cell_h - char_pixel_h) / 2.0;
-            
-            cairo_move_to(cr, pos_x, pos_y);
-            pango_cairo_show_layout(cr, layout);
+        composite_job_t job = {state, grid, (int) cell_w, (int) cell_h, 0, 0, n_bands};
+        for (int c = 0; c < ATLAS_GLYPHS; c++) {
+            const atlas_glyph_t* glyph = &state->atlas[c];
+            if (glyph->width == 0) continue;
+            if (-glyph->off_y > job.reach_up) job.reach_up = -glyph->off_y;
+            if (glyph->off_y + glyph->height - job.cell_h > job.reach_down) job.reach_down = glyph->off_y + glyph->height - job.cell_h;
+        }
+
+        cairo_surface_flush(state->surface);
+        parallel_for(n_bands, 1, composite_bands, &job);
+        cairo_surface_mark_dirty(state->surface);
+    } else if (threadpool_size() < 2 || n_bands < 2) {
+        draw_glyph_rows(cr, grid, cell_w, cell_h, 0, grid->height, 0.0);
+    } else {
+        // Blocks and dots stay inside their cell: one row of margin absorbs rounding
+        cairo_surface_flush(state->surface);
+        band_job_t job = {state, grid, options, cell_w, cell_h, 1, n_bands, 0};
+        parallel_for(n_bands, 1, render_bands, &job);
+        cairo_surface_mark_dirty(state->surface);
+
+        // Out of memory for a band: draw the whole grid again in a single pass
+        if (job.failed) {
+            double bg = options->bg_is_white ? 1.0 : 0.0;
+            cairo_set_source_rgb(cr, bg, bg, bg);
+            cairo_paint(cr);
+            draw_glyph_rows(cr, grid, cell_w, cell_h, 0, grid->height, 0.0);
         }
     }
 
-    cairo_surface_flush(surface);
-    cairo_surface_write_to_png(surface, options->output_path);
+    cairo_surface_flush(state->surface);
+    cairo_status_t status = cairo_surface_write_to_png(state->surface, options->output_path);
+    if (status != CAIRO_STATUS_SUCCESS) {
+        fprintf(stderr, "Errore scrittura PNG: %s\n", cairo_status_to_string(status));
+        return -1;
+    }
     printf("Immagine salvata correttamente: %s\n", options->output_path);
+    return 0;
+}
 
-    g_object_unref(layout);
-    pango_font_description_free(desc);
-    cairo_destroy(cr);
-    cairo_surface_destroy(surface);
+void export_ascii_to_image(ascii_grid_t* grid, export_options_t* options) {
+    export_state_t* state = export_state_create();
+    if (!state) return;
+    export_ascii_with_state(state, grid, options);
+    export_state_free(state);
 }
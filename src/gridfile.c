@@ -0,0 +1,287 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "../include/gridfile.h"
+#include "../include/packbits.h"
+
+#define HEADER_SIZE 64
+#define MAX_PLANES 8
+#define TABLE_ENTRY_SIZE 16
+#define BYTE_ORDER_MARK 0x01020304u
+// Largest grid accepted from a file, as for ASCII video: keeps every plane size in range
+#define MAX_DIMENSION 65536
+#define MAX_CELLS ((size_t) 1 << 26)
+
+// --- Little-Endian Helpers ---
+
+static void put_u32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) out[i] = (uint8_t) (value >> (8 * i));
+}
+
+static void put_u64(uint8_t* out, uint64_t value) {
+    for (int i = 0; i < 8; i++) out[i] = (uint8_t) (value >> (8 * i));
+}
+
+static uint32_t get_u32(const uint8_t* in) {
+    return (uint32_t) in[0] | ((uint32_t) in[1] << 8) | ((uint32_t) in[2] << 16) | ((uint32_t) in[3] << 24);
+}
+
+static uint64_t get_u64(const uint8_t* in) {
+    return (uint64_t) get_u32(in) | ((uint64_t) get_u32(in + 4) << 32);
+}
+
+static int host_is_little_endian(void) {
+    uint32_t probe = 1;
+    return *(const uint8_t*) &probe == 1;
+}
+
+static size_t align_offset(size_t offset) {
+    return (offset + GRIDFILE_ALIGNMENT - 1) & ~(size_t) (GRIDFILE_ALIGNMENT - 1);
+}
+
+// --- Planes ---
+
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+} plane_t;
+
+// Planes of `grid` in file order; glyphs are converted to little-endian in `glyphs_le`
+static size_t list_planes(const ascii_grid_t* grid, uint8_t* glyphs_le, plane_t* planes) {
+    size_t n_cells = grid->width * grid->height;
+    size_t n = 0;
+    planes[n++] = (plane_t) {(const uint8_t*) grid->chars, n_cells};
+    planes[n++] = (plane_t) {grid->r, n_cells};
+    planes[n++] = (plane_t) {grid->g, n_cells};
+    planes[n++] = (plane_t) {grid->b, n_cells};
+    if (grid->glyphs) {
+        for (size_t i = 0; i < n_cells; i++) put_u32(&glyphs_le[4 * i], grid->glyphs[i]);
+        planes[n++] = (plane_t) {glyphs_le, 4 * n_cells};
+    }
+    if (grid->bg_r) {
+        planes[n++] = (plane_t) {grid->bg_r, n_cells};
+        planes[n++] = (plane_t) {grid->bg_g, n_cells};
+        planes[n++] = (plane_t) {grid->bg_b, n_cells};
+    }
+    return n;
+}
+
+int gridfile_write(const char* path, const ascii_grid_t* grid, const export_options_t* options, int use_rle) {
+    if (!grid || !grid->chars) return -1;
+
+    size_t n_cells = grid->width * grid->height;
+    uint8_t* glyphs_le = grid->glyphs ? malloc(4 * n_cells) : NULL;
+    uint8_t* encoded = use_rle ? malloc(packbits_bound(4 * n_cells)) : NULL;
+    FILE* file = NULL;
+    int status = -1;
+    if ((grid->glyphs && !glyphs_le) || (use_rle && !encoded)) {
+        fprintf(stderr, "Error: Failed to allocate memory for grid file!\n");
+        goto done;
+    }
+    file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "Error: Could not create %s!\n", path);
+        goto done;
+    }
+
+    plane_t planes[MAX_PLANES];
+    size_t n_planes = list_planes(grid, glyphs_le, planes);
+    uint32_t flags = (grid->glyphs ? GRIDFILE_GLYPHS : 0) | (grid->bg_r ? GRIDFILE_BACKGROUND : 0) |
+                     (use_rle ? GRIDFILE_RLE : 0);
+
+    uint8_t header[HEADER_SIZE] = {0};
+    memcpy(header, GRIDFILE_MAGIC, 8);
+    put_u32(header + 8, GRIDFILE_VERSION);
+    put_u32(header + 12, BYTE_ORDER_MARK);
+    put_u32(header + 16, flags);
+    put_u32(header + 20, (uint32_t) grid->width);
+    put_u32(header + 24, (uint32_t) grid->height);
+    put_u32(header + 28, (uint32_t) (options ? options->cell_pixel_width : 0));
+    put_u32(header + 32, (uint32_t) (options ? options->cell_pixel_height : 0));
+    put_u32(header + 36, (uint32_t) n_planes);
+    int failed = fwrite(header, 1, HEADER_SIZE, file) != HEADER_SIZE;
+
+    // The table is written last, once the encoded sizes are known
+    uint8_t table[MAX_PLANES * TABLE_ENTRY_SIZE] = {0};
+    size_t offset = HEADER_SIZE + n_planes * TABLE_ENTRY_SIZE;
+    static const uint8_t padding[GRIDFILE_ALIGNMENT] = {0};
+    for (size_t p = 0; p < n_planes && !failed; p++) {
+        size_t aligned = align_offset(offset);
+        if (fseek(file, (long) offset, SEEK_SET) != 0 ||
+            fwrite(padding, 1, aligned - offset, file) != aligned - offset) {
+            failed = 1;
+            break;
+        }
+
+        const uint8_t* data = planes[p].data;
+        size_t size = planes[p].size;
+        if (use_rle) {
+            size = packbits_encode(planes[p].data, planes[p].size, encoded);
+            data = encoded;
+        }
+        failed = size > 0 && fwrite(data, 1, size, file) != size;
+        put_u64(&table[p * TABLE_ENTRY_SIZE], aligned);
+        put_u64(&table[p * TABLE_ENTRY_SIZE + 8], size);
+        offset = aligned + size;
+    }
+    if (!failed) {
+        failed = fseek(file, HEADER_SIZE, SEEK_SET) != 0 ||
+                 fwrite(table, 1, n_planes * TABLE_ENTRY_SIZE, file) != n_planes * TABLE_ENTRY_SIZE;
+    }
+    if (fclose(file) != 0) failed = 1;
+    if (failed) {
+        fprintf(stderr, "Error: Failed to write %s!\n", path);
+    } else {
+        status = 0;
+    }
+
+done:
+    free(glyphs_le);
+    free(encoded);
+    return status;
+}
+
+int gridfile_probe(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return 0;
+    char magic[8];
+    int match = fread(magic, 1, 8, file) == 8 && memcmp(magic, GRIDFILE_MAGIC, 8) == 0;
+    fclose(file);
+    return match;
+}
+
+// --- Loading ---
+
+// Decodes every plane into a heap grid (compressed files, or big-endian hosts)
+static int decode_planes(grid_file_t* file, const uint8_t* base, const uint64_t* offsets,
+                         const uint64_t* sizes, uint32_t flags) {
+    ascii_grid_t* grid = &file->grid;
+    size_t n_cells = grid->width * grid->height;
+    size_t width = grid->width, height = grid->height;
+    if (alloc_ascii_grid(grid, width, height, NULL) != 0 ||
+        ((flags & GRIDFILE_GLYPHS) && alloc_grid_glyphs(grid, (flags & GRIDFILE_BACKGROUND) != 0, NULL) != 0)) {
+        return -1;
+    }
+
+    uint8_t* glyphs_le = (flags & GRIDFILE_GLYPHS) ? malloc(4 * n_cells) : NULL;
+    if ((flags & GRIDFILE_GLYPHS) && !glyphs_le) return -1;
+
+    uint8_t* targets[MAX_PLANES] = {(uint8_t*) grid->chars, grid->r, grid->g, grid->b};
+    size_t n = 4;
+    if (flags & GRIDFILE_GLYPHS) targets[n++] = glyphs_le;
+    if (flags & GRIDFILE_BACKGROUND) {
+        targets[n++] = grid->bg_r;
+        targets[n++] = grid->bg_g;
+        targets[n++] = grid->bg_b;
+    }
+
+    int status = 0;
+    for (size_t p = 0; p < n && status == 0; p++) {
+        size_t length = (targets[p] == glyphs_le) ? 4 * n_cells : n_cells;
+        if (flags & GRIDFILE_RLE) {
+            status = packbits_decode(base + offsets[p], sizes[p], targets[p], length);
+        } else {
+            memcpy(targets[p], base + offsets[p], length);
+        }
+    }
+    if (status == 0 && glyphs_le) {
+        for (size_t i = 0; i < n_cells; i++) grid->glyphs[i] = get_u32(&glyphs_le[4 * i]);
+    }
+    free(glyphs_le);
+    return status;
+}
+
+int gridfile_open(grid_file_t* file, const char* path) {
+    *file = (grid_file_t) {0};
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Could not open %s.\n", path);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < HEADER_SIZE) {
+        fprintf(stderr, "Error: %s is not a grid file!\n", path);
+        close(fd);
+        return -1;
+    }
+    size_t file_size = (size_t) st.st_size;
+    // Private writable mapping: planes are used in place, writes stay copy-on-write
+    uint8_t* base = mmap(NULL, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "Error: Could not map %s!\n", path);
+        return -1;
+    }
+
+    uint32_t flags = get_u32(base + 16);
+    size_t width = get_u32(base + 20), height = get_u32(base + 24);
+    size_t n_planes = get_u32(base + 36);
+    size_t n_cells = (width <= MAX_DIMENSION && height <= MAX_DIMENSION) ? width * height : 0;
+    size_t expected = 4 + ((flags & GRIDFILE_GLYPHS) ? 1 : 0) + ((flags & GRIDFILE_BACKGROUND) ? 3 : 0);
+    int valid = memcmp(base, GRIDFILE_MAGIC, 8) == 0 && get_u32(base + 8) == GRIDFILE_VERSION &&
+                get_u32(base + 12) == BYTE_ORDER_MARK && n_cells > 0 && n_cells <= MAX_CELLS &&
+                n_planes == expected && !((flags & GRIDFILE_BACKGROUND) && !(flags & GRIDFILE_GLYPHS)) &&
+                HEADER_SIZE + n_planes * TABLE_ENTRY_SIZE <= file_size;
+
+    uint64_t offsets[MAX_PLANES], sizes[MAX_PLANES];
+    for (size_t p = 0; valid && p < n_planes; p++) {
+        offsets[p] = get_u64(base + HEADER_SIZE + p * TABLE_ENTRY_SIZE);
+        sizes[p] = get_u64(base + HEADER_SIZE + p * TABLE_ENTRY_SIZE + 8);
+        size_t length = (p == 4 && (flags & GRIDFILE_GLYPHS)) ? 4 * n_cells : n_cells;
+        valid = offsets[p] <= file_size && sizes[p] <= file_size - offsets[p] &&
+                offsets[p] % GRIDFILE_ALIGNMENT == 0 && ((flags & GRIDFILE_RLE) || sizes[p] == length);
+    }
+    if (!valid) {
+        fprintf(stderr, "Error: %s is not a valid grid file!\n", path);
+        munmap(base, file_size);
+        return -1;
+    }
+
+    file->grid.width = width;
+    file->grid.height = height;
+    file->cell_pixel_width = (int) get_u32(base + 28);
+    file->cell_pixel_height = (int) get_u32(base + 32);
+
+    if ((flags & GRIDFILE_RLE) || !host_is_little_endian()) {
+        int status = decode_planes(file, base, offsets, sizes, flags);
+        munmap(base, file_size);
+        if (status != 0) {
+            fprintf(stderr, "Error: Failed to decode %s!\n", path);
+            free_ascii_grid(&file->grid);
+            return -1;
+        }
+        return 0;
+    }
+
+    // Zero copy: the planes are the mapped file
+    ascii_grid_t* grid = &file->grid;
+    grid->chars = (char*) (base + offsets[0]);
+    grid->r = base + offsets[1];
+    grid->g = base + offsets[2];
+    grid->b = base + offsets[3];
+    if (flags & GRIDFILE_GLYPHS) grid->glyphs = (uint32_t*) (void*) (base + offsets[4]);
+    if (flags & GRIDFILE_BACKGROUND) {
+        grid->bg_r = base + offsets[5];
+        grid->bg_g = base + offsets[6];
+        grid->bg_b = base + offsets[7];
+    }
+    file->map = base;
+    file->map_size = file_size;
+    return 0;
+}
+
+void gridfile_close(grid_file_t* file) {
+    if (!file) return;
+    if (file->map) {
+        munmap(file->map, file->map_size);
+    } else {
+        free_ascii_grid(&file->grid);
+    }
+    *file = (grid_file_t) {0};
+}
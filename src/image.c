@@ -4,10 +4,138 @@
 #include "../include/stb_image.h"
 #pragma GCC diagnostic pop
 
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <sys/types.h>
 #include "../include/image.h"
+#include "../include/threadpool.h"
+#include "../include/cpu_dispatch.h"
+
+// Rows handed to the thread pool per task
+#define ROWS_PER_TASK 4
+// Largest PNM side read directly, as stb_image limits the other formats
+#define PNM_MAX_DIMENSION (1 << 24)
 
 
 image_t load_image(const char* file_path) {
+    return load_image_region(file_path, NULL);
+}
+
+
+int image_size(const char* file_path, size_t* width, size_t* height) {
+    int w, h, channels;
+    if (!stbi_info(file_path, &w, &h, &channels)) {
+        fprintf(stderr, "Error: Failed to read image '%s': %s!\n", file_path, stbi_failure_reason());
+        return -1;
+    }
+    *width = (size_t) w;
+    *height = (size_t) h;
+    return 0;
+}
+
+
+// `region` clamped to a width x height image, or the whole image if NULL or empty
+static image_region_t clamp_region(const image_region_t* region, size_t width, size_t height) {
+    if (!region || region->width == 0 || region->height == 0 || region->x >= width || region->y >= height) {
+        return (image_region_t) {0, 0, width, height};
+    }
+    image_region_t clamped = *region;
+    if (clamped.width > width - clamped.x) clamped.width = width - clamped.x;
+    if (clamped.height > height - clamped.y) clamped.height = height - clamped.y;
+    return clamped;
+}
+
+// Reads a header field of a PNM file: a decimal number after whitespace and comments.
+// Returns 0 on success, 1 if the number exceeds PNM_MAX_DIMENSION, -1 if malformed.
+static int read_pnm_field(FILE* file, size_t* value) {
+    int c = fgetc(file);
+    while (c == '#' || isspace(c)) {
+        if (c == '#') {
+            while (c != '\n' && c != EOF) c = fgetc(file);
+        }
+        c = fgetc(file);
+    }
+    if (!isdigit(c)) return -1;
+    *value = 0;
+    while (isdigit(c)) {
+        *value = *value * 10 + (size_t) (c - '0');
+        if (*value > PNM_MAX_DIMENSION) return 1;
+        c = fgetc(file);
+    }
+    return isspace(c) ? 0 : -1; // A single whitespace character ends the header
+}
+
+// Binary 8-bit PNM (P5 gray, P6 RGB) lays rows out raw after the header, so only
+// the rows and columns of the region need reading. Returns 1 if the file is such
+// a PNM (`out` is then the region, or empty on error), 0 to use the generic decoder.
+static int load_pnm_region(const char* file_path, const image_region_t* region, image_t* out) {
+    FILE* file = fopen(file_path, "rb");
+    if (!file) return 0;
+
+    char magic[2];
+    size_t width = 0, height = 0, maxval = 0;
+    if (fread(magic, 1, 2, file) != 2 || magic[0] != 'P' || (magic[1] != '5' && magic[1] != '6')) {
+        fclose(file);
+        return 0;
+    }
+    int header = read_pnm_field(file, &width);
+    if (header == 0) header = read_pnm_field(file, &height);
+    if (header == 0) header = read_pnm_field(file, &maxval);
+    *out = (image_t) {0};
+    if (header > 0) {
+        fprintf(stderr, "Error: Image '%s' is too large!\n", file_path);
+        fclose(file);
+        return 1;
+    }
+    if (header < 0 || maxval != 255 || width == 0 || height == 0) {
+        fclose(file);
+        return 0;
+    }
+
+    size_t channels = (magic[1] == '6') ? 3 : 1;
+    image_region_t roi = clamp_region(region, width, height);
+    off_t data_start = ftello(file);
+    if (roi.width > SIZE_MAX / channels || roi.height > SIZE_MAX / sizeof(double) / (roi.width * channels)) {
+        fprintf(stderr, "Error: Image '%s' is too large!\n", file_path);
+        fclose(file);
+        return 1;
+    }
+    size_t row_size = roi.width * channels;
+    double* data = malloc(roi.height * row_size * sizeof(*data));
+    unsigned char* row = malloc(row_size);
+    if (!data || !row) {
+        fprintf(stderr, "Error: Failed to allocate memory for image data!\n");
+        free(data);
+        free(row);
+        fclose(file);
+        return 1;
+    }
+
+    for (size_t y = 0; y < roi.height; y++) {
+        off_t offset = data_start + (off_t) (((roi.y + y) * width + roi.x) * channels);
+        if (fseeko(file, offset, SEEK_SET) != 0 || fread(row, 1, row_size, file) != row_size) {
+            fprintf(stderr, "Error: Failed to load image '%s': truncated file!\n", file_path);
+            free(data);
+            free(row);
+            fclose(file);
+            return 1;
+        }
+        double* dst = &data[y * row_size];
+        for (size_t i = 0; i < row_size; i++) dst[i] = row[i] / 255.0;
+    }
+
+    free(row);
+    fclose(file);
+    *out = (image_t) {roi.width, roi.height, channels, data};
+    return 1;
+}
+
+
+image_t load_image_region(const char* file_path, const image_region_t* region) {
+    image_t image;
+    if (load_pnm_region(file_path, region, &image)) return image;
+
     int width, height, channels;
     unsigned char* raw_data = stbi_load(file_path, &width, &height, &channels, 0);
 
@@ -16,30 +144,99 @@ image_t load_image(const char* file_path) {
         return (image_t) {0}; // Return empty image on failure
     }
 
-    // Convert to [0., 1.]
-    size_t total_size = (size_t) width * height * channels;
-    double* data = calloc(total_size, sizeof(*data));
+    // Convert the region to [0., 1.]
+    image_region_t roi = clamp_region(region, (size_t) width, (size_t) height);
+    size_t row_size = roi.width * channels;
+    double* data = calloc(roi.height * row_size, sizeof(*data));
     if (!data) {
         fprintf(stderr, "Error: Failed to allocate memory for image data!\n");
         stbi_image_free(raw_data);
         return (image_t) {0}; // Return empty image on failure
     }
 
-    for (size_t i = 0; i < total_size; i++) {
-        data[i] = raw_data[i] / 255.0;
+    for (size_t y = 0; y < roi.height; y++) {
+        const unsigned char* src = &raw_data[((roi.y + y) * (size_t) width + roi.x) * channels];
+        double* dst = &data[y * row_size];
+        for (size_t i = 0; i < row_size; i++) {
+            dst[i] = src[i] / 255.0;
+        }
     }
 
     stbi_image_free(raw_data);
 
     return (image_t) {
-        .width = (size_t) width,
-        .height = (size_t) height,
+        .width = roi.width,
+        .height = roi.height,
         .channels = (size_t) channels,
         .data = data
     };
 }
 
 
+animation_t load_animation(const char* file_path) {
+    animation_t animation = {0};
+
+    // stb decodes every GIF frame only from memory
+    FILE* file = fopen(file_path, "rb");
+    if (!file) {
+        fprintf(stderr, "Error: Failed to open '%s'!\n", file_path);
+        return animation;
+    }
+    unsigned char* contents = NULL;
+    long size = -1;
+    if (fseek(file, 0, SEEK_END) == 0) size = ftell(file);
+    if (size > 0 && size <= INT32_MAX && fseek(file, 0, SEEK_SET) == 0) {
+        contents = malloc((size_t) size);
+        if (contents && fread(contents, 1, (size_t) size, file) != (size_t) size) {
+            free(contents);
+            contents = NULL;
+        }
+    }
+    fclose(file);
+    if (!contents) {
+        fprintf(stderr, "Error: Failed to read '%s'!\n", file_path);
+        return animation;
+    }
+
+    int width, height, n_frames, channels;
+    int* delays = NULL;
+    unsigned char* frames = stbi_load_gif_from_memory(contents, (int) size, &delays, &width, &height,
+                                                      &n_frames, &channels, 0);
+    free(contents);
+    if (!frames) {
+        fprintf(stderr, "Error: Failed to load animation '%s': %s!\n", file_path, stbi_failure_reason());
+        return animation;
+    }
+
+    // Delays are handed over as is: keep them in our own allocation
+    animation.delays_ms = malloc((size_t) n_frames * sizeof(*animation.delays_ms));
+    if (!animation.delays_ms) {
+        fprintf(stderr, "Error: Failed to allocate memory for animation!\n");
+        stbi_image_free(frames);
+        stbi_image_free(delays);
+        return animation;
+    }
+    for (int i = 0; i < n_frames; i++) {
+        animation.delays_ms[i] = delays ? delays[i] : 0;
+    }
+    stbi_image_free(delays);
+
+    animation.width = (size_t) width;
+    animation.height = (size_t) height;
+    animation.channels = (size_t) channels;
+    animation.n_frames = (size_t) n_frames;
+    animation.pixels = frames;
+    return animation;
+}
+
+void free_animation(animation_t* animation) {
+    if (animation) {
+        stbi_image_free(animation->pixels);
+        free(animation->delays_ms);
+        *animation = (animation_t) {0};
+    }
+}
+
 void free_image(image_t* image) {
     if (image && image->data) {
         free(image->data);
@@ -48,12 +245,83 @@ void free_image(image_t* image) {
     }
 }
 
+// Planes are padded to the arena alignment so every plane starts on a cache line
+static size_t plane_stride(size_t n_cells) {
+    return (n_cells + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1);
+}
+
+int alloc_ascii_grid(ascii_grid_t* grid, size_t width, size_t height, arena_t* arena) {
+    size_t stride = plane_stride(width * height);
+    unsigned char* planes = arena ? arena_alloc(arena, 4 * stride) : malloc(4 * stride);
+    if (!planes) {
+        *grid = (ascii_grid_t) {0};
+        return -1;
+    }
+
+    grid->width = width;
+    grid->height = height;
+    grid->chars = (char*) planes;
+    grid->r = planes + stride;
+    grid->g = planes + 2 * stride;
+    grid->b = planes + 3 * stride;
+    grid->glyphs = NULL;
+    grid->bg_r = grid->bg_g = grid->bg_b = NULL;
+    return 0;
+}
+
+int alloc_grid_glyphs(ascii_grid_t* grid, int with_background, arena_t* arena) {
+    size_t n_cells = grid->width * grid->height;
+    size_t glyph_stride = plane_stride(n_cells * sizeof(uint32_t));
+    size_t stride = plane_stride(n_cells);
+    size_t total = glyph_stride + (with_background ? 3 * stride : 0);
+    unsigned char* planes = arena ? arena_alloc(arena, total) : malloc(total);
+    if (!planes) return -1;
+
+    grid->glyphs = (uint32_t*) planes;
+    if (with_background) {
+        grid->bg_r = planes + glyph_stride;
+        grid->bg_g = planes + glyph_stride + stride;
+        grid->bg_b = planes + glyph_stride + 2 * stride;
+    }
+    return 0;
+}
+
+int copy_ascii_grid(ascii_grid_t* dst, const ascii_grid_t* src) {
+    int reuse = dst->chars && dst->width == src->width && dst->height == src->height &&
+                (dst->glyphs != NULL) == (src->glyphs != NULL) && (dst->bg_r != NULL) == (src->bg_r != NULL);
+    if (!reuse) {
+        free_ascii_grid(dst);
+        if (alloc_ascii_grid(dst, src->width, src->height, NULL) != 0) return -1;
+        if (src->glyphs && alloc_grid_glyphs(dst, src->bg_r != NULL, NULL) != 0) {
+            free_ascii_grid(dst);
+            return -1;
+        }
+    }
+
+    size_t n_cells = src->width * src->height;
+    memcpy(dst->chars, src->chars, n_cells);
+    memcpy(dst->r, src->r, n_cells);
+    memcpy(dst->g, src->g, n_cells);
+    memcpy(dst->b, src->b, n_cells);
+    if (src->glyphs) memcpy(dst->glyphs, src->glyphs, n_cells * sizeof(*src->glyphs));
+    if (src->bg_r) {
+        memcpy(dst->bg_r, src->bg_r, n_cells);
+        memcpy(dst->bg_g, src->bg_g, n_cells);
+        memcpy(dst->bg_b, src->bg_b, n_cells);
+    }
+    return 0;
+}
+
 void free_ascii_grid(ascii_grid_t* grid) {
     if (grid) {
-        if (grid->cells) {
-            free(grid->cells);
-            grid->cells = NULL;
+        if (grid->chars) {
+            free(grid->chars);
+            grid->chars = NULL;
+            grid->r = grid->g = grid->b = NULL;
         }
+        free(grid->glyphs);
+        grid->glyphs = NULL;
+        grid->bg_r = grid->bg_g = grid->bg_b = NULL;
         grid->width = 0;
         grid->height = 0;
         // Note: we don't free the struct pointer itself if it was stack allocated, 
@@ -63,6 +331,13 @@ void free_ascii_grid(ascii_grid_t* grid) {
 }
 
 
+// Zeroed pixel storage from the arena if given, from the heap otherwise
+static double* alloc_pixels(size_t count, arena_t* arena) {
+    if (arena) return arena_calloc(arena, count, sizeof(double));
+    return calloc(count, sizeof(double));
+}
+
+
 // Gets pointer to pixel data at index (x, y)
 double* get_pixel(image_t* image, size_t x, size_t y) {
     return &image->data[(y * image->width + x) * image->channels];
@@ -79,7 +354,7 @@ void set_pixel(image_t* image, size_t x, size_t y, const double* new_pixel) {
 
 
 // Gets average pixel value in rectangular region; writes to `average`
-void get_average(image_t* image, double* average, size_t x1, size_t x2, size_t y1, size_t y2) {
+static inline void get_average(image_t* image, double* average, size_t x1, size_t x2, size_t y1, size_t y2) {
     // Set average to zero
     for (size_t c = 0; c < image->channels; c++) {
         average[c] = 0.0;
@@ -103,36 +378,81 @@ void get_average(image_t* image, double* average, size_t x1, size_t x2, size_t y
 }
 
 
-image_t make_resized(image_t* original, size_t max_width, size_t max_height, double character_ratio) {
+typedef struct {
+    image_t* original;
+    image_region_t region;  // Part of the original covered by the output
+    double* data;
+    size_t width, height, channels;
+    const uint8_t* mask;    // If not NULL, only pixels with a non-zero entry are computed
+} resize_job_t;
+
+HOT_KERNEL
+static void resize_rows(void* arg, size_t row_begin, size_t row_end) {
+    resize_job_t* job = arg;
+    image_t* original = job->original;
+    const image_region_t* region = &job->region;
+    size_t width = job->width, height = job->height, channels = job->channels;
+
+    // i, j are coordinates in resized image; blocks start at the region's corner
+    for (size_t j = row_begin; j < row_end; j++) {
+        size_t y1 = region->y + (j * region->height) / (height);
+        size_t y2 = region->y + ((j + 1) * region->height) / (height);
+        for (size_t i = 0; i < width; i++) {
+            if (job->mask && !job->mask[i + j * width]) continue;
+            size_t x1 = region->x + (i * region->width) / (width);
+            size_t x2 = region->x + ((i + 1) * region->width) / (width);
+
+            get_average(original, &job->data[(i + j * width) * channels], x1, x2, y1, y2);
+        }
+    }
+}
+
+
+// The whole image if `region` is NULL
+static image_region_t full_region(const image_t* image, const image_region_t* region) {
+    return region ? *region : (image_region_t) {0, 0, image->width, image->height};
+}
+
+image_t make_resized(image_t* original, size_t max_width, size_t max_height, double character_ratio, arena_t* arena) {
+    return make_resized_region(original, NULL, max_width, max_height, character_ratio, arena);
+}
+
+
+image_t make_resized_region(image_t* original, const image_region_t* region, size_t max_width, size_t max_height,
+                            double character_ratio, arena_t* arena) {
+    image_region_t source = full_region(original, region);
     size_t width, height;
-    size_t channels = original->channels;
 
     // Note: Dividing heights by 2 for approximate terminal font aspect ratio
-    size_t proposed_height = (original->height * max_width) / (character_ratio * original->width);
+    size_t proposed_height = (source.height * max_width) / (character_ratio * source.width);
     if (proposed_height <= max_height) {
         width = max_width, height = proposed_height;
     } else {
-        width = (character_ratio * original->width * max_height) / (original->height);
+        width = (character_ratio * source.width * max_height) / (source.height);
         height = max_height;
     }
 
-    double* data = calloc(width * height * channels, sizeof(*data));
+    return make_downsampled_region(original, &source, width, height, arena);
+}
+
+
+image_t make_downsampled(image_t* original, size_t width, size_t height, arena_t* arena) {
+    return make_downsampled_region(original, NULL, width, height, arena);
+}
+
+
+image_t make_downsampled_region(image_t* original, const image_region_t* region, size_t width, size_t height,
+                                arena_t* arena) {
+    size_t channels = original->channels;
+    double* data = alloc_pixels(width * height * channels, arena);
     if (!data) {
         fprintf(stderr, "Error: Failed to allocate memory for resized image!\n");
         return (image_t) {0};
     }
 
-    // i, j are coordinates in resized image
-    for (size_t j = 0; j < height; j++) {
-        size_t y1 = (j * original->height) / (height);
-        size_t y2 = ((j + 1) * original->height) / (height);
-        for (size_t i = 0; i < width; i++) {
-            size_t x1 = (i * original->width) / (width);
-            size_t x2 = ((i + 1) * original->width) / (width);
-
-            get_average(original, &data[(i + j * width) * channels], x1, x2, y1, y2);
-        }
-    }
+    // Output rows are independent: each task averages its own band of the original
+    resize_job_t job = {original, full_region(original, region), data, width, height, channels, NULL};
+    parallel_for(height, 1, resize_rows, &job);
 
     return (image_t) {
         .width = width,
@@ -143,13 +463,37 @@ image_t make_resized(image_t* original, size_t max_width, size_t max_height, dou
 }
 
 
-// Create grayscale version of image. Note: Assumes original is at least RGB.
-image_t make_grayscale(image_t* original) {
+void update_resized(image_t* original, const image_region_t* region, image_t* resized, const uint8_t* mask) {
+    resize_job_t job = {original, full_region(original, region), resized->data, resized->width, resized->height,
+                        resized->channels, mask};
+    parallel_for(resized->height, 1, resize_rows, &job);
+}
+
+
+// Luminance-weighted graycsale. Could be a callback...
+// Images with fewer than 3 channels are already gray: their first channel is copied.
+HOT_KERNEL
+static void grayscale_pixels(const double* src, size_t channels, double* dst, size_t n_pixels) {
+    if (channels < 3) {
+        for (size_t i = 0; i < n_pixels; i++) {
+            dst[i] = src[i * channels];
+        }
+        return;
+    }
+    for (size_t i = 0; i < n_pixels; i++) {
+        const double* pixel = &src[i * channels];
+        dst[i] = 0.2126 * pixel[0] + 0.7152 * pixel[1] + 0.0722 * pixel[2];
+    }
+}
+
+
+// Create grayscale version of image
+image_t make_grayscale(image_t* original, arena_t* arena) {
     size_t width = original->width;
     size_t height = original->height;
     size_t channels = 1;
 
-    double* data = calloc(width * height, sizeof(*data));
+    double* data = alloc_pixels(width * height, arena);
     if (!data) {
         fprintf(stderr, "Error: Failed to allocate memory for resized image!\n");
         return (image_t) {0};
@@ -162,18 +506,26 @@ image_t make_grayscale(image_t* original) {
         .data = data
     };
 
-    for (size_t y = 0; y < height; y++) {
-        for (size_t x = 0; x < width; x++) {
-            double* pixel = get_pixel(original, x, y);
+    grayscale_pixels(original->data, original->channels, data, width * height);
+
+    return new;
+}
 
-            // Luminance-weighted graycsale. Could be a callback...
-            double grayscale = 0.2126 * pixel[0] + 0.7152 * pixel[1] + 0.0722 * pixel[2];
 
-            set_pixel(&new, x, y, &grayscale);
+// Grayscale of the masked pixels only, one run of consecutive masked pixels at a time
+void update_grayscale(image_t* original, image_t* grayscale, const uint8_t* mask) {
+    size_t n_pixels = grayscale->width * grayscale->height;
+    size_t i = 0;
+    while (i < n_pixels) {
+        if (!mask[i]) {
+            i++;
+            continue;
         }
+        size_t run = i;
+        while (run < n_pixels && mask[run]) run++;
+        grayscale_pixels(&original->data[i * original->channels], original->channels, &grayscale->data[i], run - i);
+        i = run;
     }
-
-    return new;
 }
 
 
@@ -193,19 +545,74 @@ double calculate_convolution_value(image_t* image, double* kernel, size_t x, siz
 }
 
 
-// Calculates convolution with 3x3 kernel. Ignores edges.
-void get_convolution(image_t* image, double* kernel, double* out) {
-    for (size_t y = 1; y < image->height - 1; y++) {
+typedef struct {
+    image_t* image;
+    double* kernel;
+    double* out;
+    const uint8_t* mask;    // If not NULL, only pixels with a non-zero entry are computed
+} convolution_job_t;
+
+// 3x3 taps around column x, summed in the same order as calculate_convolution_value
+static inline double convolution_taps(const double* k, const double* above, const double* row,
+                                      const double* below, size_t x) {
+    double result = 0.0;
+    result += k[0] * above[x - 1]; result += k[1] * above[x]; result += k[2] * above[x + 1];
+    result += k[3] * row[x - 1];   result += k[4] * row[x];   result += k[5] * row[x + 1];
+    result += k[6] * below[x - 1]; result += k[7] * below[x]; result += k[8] * below[x + 1];
+    return result;
+}
+
+// Task over interior rows [row_begin + 1, row_end + 1)
+HOT_KERNEL
+static void convolution_rows(void* arg, size_t row_begin, size_t row_end) {
+    convolution_job_t* job = arg;
+    image_t* image = job->image;
+
+    // Single channel (Sobel on grayscale): straight loop over x that the compiler
+    // vectorizes. Taps are summed in the same order as calculate_convolution_value.
+    if (image->channels == 1) {
+        const double* k = job->kernel;
+        size_t width = image->width;
+        for (size_t y = row_begin + 1; y < row_end + 1; y++) {
+            const double* above = &image->data[(y - 1) * width];
+            const double* row = &image->data[y * width];
+            const double* below = &image->data[(y + 1) * width];
+            double* out = &job->out[y * width];
+            if (job->mask) {
+                const uint8_t* mask = &job->mask[y * width];
+                for (size_t x = 1; x < width - 1; x++) {
+                    if (mask[x]) out[x] = convolution_taps(k, above, row, below, x);
+                }
+                continue;
+            }
+            for (size_t x = 1; x < width - 1; x++) {
+                out[x] = convolution_taps(k, above, row, below, x);
+            }
+        }
+        return;
+    }
+
+    for (size_t y = row_begin + 1; y < row_end + 1; y++) {
         for (size_t x = 1; x < image->width - 1; x++) {
+            if (job->mask && !job->mask[x + y * image->width]) continue;
             for (size_t c = 0; c < image->channels; c++) {
                 size_t image_index = c + (x + y * image->width) * image->channels;
-                out[image_index] = calculate_convolution_value(image, kernel, x, y, c);
+                job->out[image_index] = calculate_convolution_value(image, job->kernel, x, y, c);
             }
         }
     }
 }
 
 
+// Calculates convolution with 3x3 kernel. Ignores edges.
+void get_convolution(image_t* image, double* kernel, double* out) {
+    if (image->height < 3 || image->width < 3) return;
+
+    convolution_job_t job = {image, kernel, out, NULL};
+    parallel_for(image->height - 2, ROWS_PER_TASK, convolution_rows, &job);
+}
+
+
 // Calculates sobel convolutions
 void get_sobel(image_t* image, double* out_x, double* out_y) {
     double Gx[] = {-1., 0., 1., -2., 0., 2., -1., 0., 1};
@@ -214,3 +621,16 @@ void get_sobel(image_t* image, double* out_x, double* out_y) {
     get_convolution(image, Gx, out_x);
     get_convolution(image, Gy, out_y);
 }
+
+
+// Sobel of the masked pixels only; the others keep their previous values
+void update_sobel(image_t* image, double* out_x, double* out_y, const uint8_t* mask) {
+    if (image->height < 3 || image->width < 3) return;
+
+    double Gx[] = {-1., 0., 1., -2., 0., 2., -1., 0., 1};
+    double Gy[] = {1., 2., 1., 0., 0., 0., -1., -2., -1};
+    convolution_job_t job_x = {image, Gx, out_x, mask};
+    convolution_job_t job_y = {image, Gy, out_y, mask};
+    parallel_for(image->height - 2, ROWS_PER_TASK, convolution_rows, &job_x);
+    parallel_for(image->height - 2, ROWS_PER_TASK, convolution_rows, &job_y);
+}
@@ -1,49 +1,583 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/inotify.h>
 
 #include "../include/image.h"
-#include "../include/print_image.h"
 #include "../include/argparse.h"
-#include "../include/process.h"
-#include "../include/export.h"
+#include "../include/asciiview.h"
+#include "../include/adaptive.h"
+#include "../include/animation.h"
+#include "../include/video.h"
+#include "../include/transcode.h"
+#include "../include/gridfile.h"
+#include "../include/asciivideo.h"
+#include "../include/viewer.h"
+
+// Frames formatted ahead of the terminal in slideshows
+#define OUTPUT_BUFFERS 3
+// Frame rate of stdin video when neither --fps nor the stream gives one
+#define DEFAULT_VIDEO_FPS 30.0
+// Quiet time after the last write to a watched file before it is read again
+#define WATCH_DEBOUNCE_MS 100
+
+static volatile sig_atomic_t interrupted = 0;
+
+static void on_interrupt(int signal_number) {
+    (void) signal_number;
+    interrupted = 1;
+}
+
+static void sleep_seconds(double seconds) {
+    struct timespec ts;
+    ts.tv_sec = (time_t) seconds;
+    ts.tv_nsec = (long) ((seconds - (double) ts.tv_sec) * 1e9);
+    while (nanosleep(&ts, &ts) != 0) {}
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int is_gif(const char* path) {
+    size_t length = strlen(path);
+    return length > 4 && strcasecmp(path + length - 4, ".gif") == 0;
+}
+
+// Resolves --crop against a width x height source into `region` (all zero without
+// --crop). Returns -1 if the region starts outside the source.
+static int resolve_crop(const struct arguments* args, size_t width, size_t height, image_region_t* region) {
+    *region = (image_region_t) {0};
+    if (!args->has_crop) return 0;
+
+    double value[4];
+    for (int k = 0; k < 4; k++) {
+        double extent = (double) ((k % 2 == 0) ? width : height);
+        value[k] = args->crop_percent[k] ? args->crop[k] * extent / 100.0 : args->crop[k];
+    }
+    region->x = (size_t) (value[0] + 0.5);
+    region->y = (size_t) (value[1] + 0.5);
+    region->width = (size_t) (value[2] + 0.5);
+    region->height = (size_t) (value[3] + 0.5);
+    if (region->x >= width || region->y >= height || region->width == 0 || region->height == 0) {
+        fprintf(stderr, "Error: Crop region lies outside the %zux%zu source.\n", width, height);
+        return -1;
+    }
+    if (region->width > width - region->x) region->width = width - region->x;
+    if (region->height > height - region->y) region->height = height - region->y;
+    return 0;
+}
+
+// Loads an image, or only its --crop region: the returned image is the region itself
+static image_t load_source(const struct arguments* args, const char* path) {
+    if (!args->has_crop) return load_image(path);
+
+    size_t width, height;
+    image_region_t region;
+    if (image_size(path, &width, &height) != 0 || resolve_crop(args, width, height, &region) != 0) {
+        return (image_t) {0};
+    }
+    return load_image_region(path, &region);
+}
+
+// Plays the cached frames at their delays. A frame whose display time is already
+// over when its turn comes is skipped, so playback keeps to the clock.
+// The decoded frames are released once converted.
+static int play_animation(asciiview_ctx_t* ctx, struct arguments* args, animation_t* animation) {
+    export_options_t options = args->options;
+    if (resolve_crop(args, animation->width, animation->height, &options.crop) != 0) {
+        free_animation(animation);
+        return 1;
+    }
+    frame_cache_t cache;
+    int built = frame_cache_build(&cache, animation, &options);
+    free_animation(animation);
+    if (built != 0) return 1;
+
+    if (asciiview_set_async_output(ctx, OUTPUT_BUFFERS) != 0) {
+        fprintf(stderr, "Warning: Writing frames synchronously.\n");
+    }
+
+    double due = now_seconds();
+    for (int loop = 0; args->loops == 0 || loop < args->loops; loop++) {
+        int last_loop = (args->loops != 0 && loop + 1 == args->loops);
+        for (size_t f = 0; f < cache.n_frames; f++) {
+            double next_due = due + cache.delays_ms[f] / 1000.0;
+            double now = now_seconds();
+            if (now >= next_due && !(last_loop && f + 1 == cache.n_frames)) {
+                due = next_due;
+                continue;
+            }
+            if (due > now) sleep_seconds(due - now);
+            asciiview_redraw_grid(ctx, &cache.grids[f], &options);
+            due = next_due;
+        }
+    }
+
+    int status = asciiview_flush_output(ctx) == 0 ? 0 : 1;
+    frame_cache_free(&cache);
+    return status;
+}
+
+// Shows video frames from stdin at the target rate. The reader thread keeps only
+// the newest frame, so whatever arrives while a frame converts or prints is
+// dropped instead of queued: latency stays at about one frame.
+// Frames are written synchronously so the reported latency includes the terminal.
+static int run_video(asciiview_ctx_t* ctx, struct arguments* args) {
+    video_reader_t* reader = video_reader_open(STDIN_FILENO, (size_t) args->video_width, (size_t) args->video_height);
+    if (!reader) return 1;
+
+    const video_stream_t* stream = video_reader_stream(reader);
+    size_t width = stream->width, height = stream->height;
+    double fps = args->fps > 0.0 ? args->fps : video_stream_fps(stream);
+    if (fps <= 0.0) fps = DEFAULT_VIDEO_FPS;
+
+    uint8_t* rgb = malloc(width * height * 3);
+    if (!rgb) {
+        fprintf(stderr, "Error: Failed to allocate memory for video frames!\n");
+        video_reader_close(reader);
+        return 1;
+    }
+
+    export_options_t options = args->options;
+    if (resolve_crop(args, width, height, &options.crop) != 0) {
+        video_reader_close(reader);
+        free(rgb);
+        return 1;
+    }
+
+    // Consecutive frames mostly repeat each other: only changed cells are recomputed
+    asciiview_set_incremental(ctx, 1);
+
+    latency_stats_t latency = {0};
+    uint64_t shown = 0;
+    double period = 1.0 / fps;
+    double start = now_seconds(), due = start;
+    video_frame_t frame;
+    while (video_reader_next(reader, &frame) == 0) {
+        ascii_grid_t grid = asciiview_convert_rgb8(ctx, video_stream_to_rgb(stream, frame.data, rgb), width, height, 3, &options);
+        if (!grid.chars) {
+            fprintf(stderr, "Error: Failed to process video frame.\n");
+            break;
+        }
+        asciiview_redraw(ctx, &options);
+        latency_stats_add(&latency, now_seconds() - frame.arrival);
+        shown++;
+
+        // Next slot; a late frame does not earn the following ones a shorter period
+        due += period;
+        double now = now_seconds();
+        if (due > now) sleep_seconds(due - now);
+        else due = now;
+    }
+    double elapsed = now_seconds() - start;
+
+    uint64_t n_read, n_dropped;
+    video_reader_counts(reader, &n_read, &n_dropped);
+    video_reader_close(reader);
+    free(rgb);
+
+    fprintf(stderr, "Video: %llu frames read, %llu shown, %llu dropped, %.1f fps shown (target %.1f)\n",
+            (unsigned long long) n_read, (unsigned long long) shown, (unsigned long long) n_dropped,
+            elapsed > 0.0 ? shown / elapsed : 0.0, fps);
+    latency_stats_print(&latency, "Latency (frame read to terminal)", stderr);
+    return shown > 0 ? 0 : 1;
+}
+
+// Converts a whole video file (or stdin) to an ASCII video file, as fast as the cores allow
+static int run_transcode(struct arguments* args) {
+    int from_stdin = strcmp(args->filename, "-") == 0;
+    int fd = from_stdin ? STDIN_FILENO : open(args->filename, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Could not open %s.\n", args->filename);
+        return 1;
+    }
+
+    video_stream_t stream;
+    export_options_t options = args->options;
+    int status = 1;
+    if (video_stream_open(&stream, fd, (size_t) args->video_width, (size_t) args->video_height) == 0 &&
+        resolve_crop(args, stream.width, stream.height, &options.crop) == 0) {
+        // Frame rate kept in the file: --fps, then the stream's, then the default
+        uint32_t fps_num = stream.fps_num, fps_den = stream.fps_den;
+        if (args->fps > 0.0) {
+            fps_num = (uint32_t) (args->fps * 1000.0 + 0.5);
+            fps_den = 1000;
+        } else if (fps_den == 0) {
+            fps_num = (uint32_t) DEFAULT_VIDEO_FPS;
+            fps_den = 1;
+        }
+
+        transcode_stats_t stats;
+        if (transcode_video(&stream, args->transcode_path, &options, (size_t) args->window,
+                            fps_num, fps_den, &stats) == 0) {
+            status = 0;
+            fprintf(stderr, "Transcoded %zu frames in %.2f s (%.1f frames/s, %zu workers, window of %zu frames)\n",
+                    stats.n_frames, stats.seconds, stats.seconds > 0.0 ? stats.n_frames / stats.seconds : 0.0,
+                    stats.n_workers, stats.window);
+        }
+    }
+
+    if (!from_stdin) close(fd);
+    return status;
+}
+
+// Prints or exports a grid saved by --save-grid, without reprocessing anything
+static int show_grid_file(asciiview_ctx_t* ctx, struct arguments* args) {
+    grid_file_t file;
+    if (gridfile_open(&file, args->filename) != 0) return 1;
+
+    export_options_t options = args->options;
+    options.cell_pixel_width = file.cell_pixel_width > 0 ? file.cell_pixel_width : 8;
+    options.cell_pixel_height = file.cell_pixel_height > 0 ? file.cell_pixel_height : 16;
+    int status = 0;
+    if (options.export_image) {
+        if (asciiview_export_grid(ctx, &file.grid, &options) != 0) status = 1;
+    } else {
+        asciiview_print_grid(ctx, &file.grid, &options);
+    }
+
+    gridfile_close(&file);
+    return status;
+}
+
+// Plays an ASCII video file at its frame rate. Each frame only sends the cells its
+// delta (or keyframe) changed; frames are decoded one at a time, so memory does not
+// depend on the length of the video.
+static int play_ascii_video(asciiview_ctx_t* ctx, struct arguments* args) {
+    asciivideo_reader_t* reader = asciivideo_reader_open(args->filename);
+    if (!reader) return 1;
+
+    double fps = args->fps > 0.0 ? args->fps : asciivideo_reader_fps(reader);
+    if (fps <= 0.0) fps = DEFAULT_VIDEO_FPS;
+    if (asciiview_set_async_output(ctx, OUTPUT_BUFFERS) != 0) {
+        fprintf(stderr, "Warning: Writing frames synchronously.\n");
+    }
+
+    int status = 0;
+    double period = 1.0 / fps;
+    double due = now_seconds();
+    for (int loop = 0; status == 0 && (args->loops == 0 || loop < args->loops); loop++) {
+        if (loop > 0 && asciivideo_reader_seek(reader, 0) != 0) break;
+        asciivideo_frame_t frame;
+        int result;
+        while ((result = asciivideo_read_frame(reader, &frame)) == 0) {
+            double now = now_seconds();
+            if (due > now) sleep_seconds(due - now);
+            asciiview_draw_spans(ctx, frame.grid, frame.spans, frame.n_spans, frame.clear, &args->options);
+            due += period;
+        }
+        if (result < 0) status = 1;
+    }
+
+    if (asciiview_flush_output(ctx) != 0) status = 1;
+    asciivideo_reader_close(reader);
+    return status;
+}
+
+// Converts `original` into the context. With an adaptive controller, starts from the
+// requested settings and steps down until the frame fits the budget; `options`
+// receives the settings actually used (for printing and reporting).
+static ascii_grid_t convert(asciiview_ctx_t* ctx, image_t* original, struct arguments* args,
+                            adaptive_t* adaptive, int redraw, export_options_t* options, size_t* frame_bytes) {
+    *options = args->options;
+    ascii_grid_t grid = asciiview_convert(ctx, original, options);
+    if (!adaptive) return grid;
+
+    size_t budget = adaptive_budget(adaptive);
+    *frame_bytes = asciiview_frame_size(ctx, options, redraw);
+    while (grid.chars && budget > 0 && *frame_bytes > budget && adaptive_degrade(options)) {
+        grid = asciiview_convert(ctx, original, options);
+        *frame_bytes = asciiview_frame_size(ctx, options, redraw);
+    }
+    return grid;
+}
+
+// Feeds the controller with what the terminal absorbed since the last call
+static void observe_output(asciiview_ctx_t* ctx, adaptive_t* adaptive, size_t* last_bytes, double* last_seconds) {
+    size_t bytes;
+    double seconds;
+    asciiview_output_totals(ctx, &bytes, &seconds);
+    if (adaptive) adaptive_observe(adaptive, bytes - *last_bytes, seconds - *last_seconds);
+    *last_bytes = bytes;
+    *last_seconds = seconds;
+}
+
+// Shows every image in turn; consecutive frames only resend the cells that changed.
+// Frames are written by the output thread while the next image loads and converts.
+static int run_slideshow(asciiview_ctx_t* ctx, struct arguments* args, adaptive_t* adaptive) {
+    if (asciiview_set_async_output(ctx, OUTPUT_BUFFERS) != 0) {
+        fprintf(stderr, "Warning: Writing frames synchronously.\n");
+    }
+    asciiview_set_incremental(ctx, 1);
+
+    int shown = 0;
+    export_options_t options = args->options;
+    size_t frame_bytes = 0, last_bytes = 0;
+    double last_seconds = 0.0;
+    for (int i = 0; i < args->n_files; i++) {
+        image_t original = load_source(args, args->filenames[i]);
+        if (!original.data) continue; // Error printed inside load_source
+
+        ascii_grid_t grid = convert(ctx, &original, args, adaptive, 1, &options, &frame_bytes);
+        free_image(&original);
+        if (!grid.chars) {
+            fprintf(stderr, "Error: Failed to process image %s.\n", args->filenames[i]);
+            continue;
+        }
+
+        if (shown++ > 0) sleep_seconds(args->delay);
+        asciiview_redraw(ctx, &options);
+        observe_output(ctx, adaptive, &last_bytes, &last_seconds);
+    }
+
+    if (asciiview_flush_output(ctx) != 0) {
+        fprintf(stderr, "Error: Failed to write to the terminal.\n");
+    }
+    if (adaptive && shown > 0) adaptive_report(adaptive, &options, frame_bytes, stderr);
+    return shown > 0 ? 0 : 1;
+}
+
+// Drains the pending inotify events; returns whether one concerns `name`
+static int read_watch_events(int fd, const char* name) {
+    union {
+        struct inotify_event event;
+        char bytes[4096];
+    } buffer;
+    ssize_t length = read(fd, buffer.bytes, sizeof(buffer.bytes));
+    int match = 0;
+    for (ssize_t offset = 0; offset < length;) {
+        const struct inotify_event* event = (const struct inotify_event*) (buffer.bytes + offset);
+        if ((event->mask & IN_Q_OVERFLOW) || (event->len > 0 && strcmp(event->name, name) == 0)) match = 1;
+        offset += (ssize_t) (sizeof(*event) + event->len);
+    }
+    return match;
+}
+
+// Loads, converts and shows (or exports) the watched image. Returns 0 on success.
+static int render_watched(asciiview_ctx_t* ctx, struct arguments* args, adaptive_t* adaptive) {
+    image_t original = load_source(args, args->filename);
+    if (!original.data) return -1; // Error printed inside load_source
+
+    export_options_t options;
+    size_t frame_bytes = 0;
+    ascii_grid_t grid = convert(ctx, &original, args, adaptive, 1, &options, &frame_bytes);
+    free_image(&original);
+    if (!grid.chars) {
+        fprintf(stderr, "Error: Failed to process image.\n");
+        return -1;
+    }
+    if (options.export_image) return asciiview_export(ctx, &options);
+    asciiview_redraw(ctx, &options);
+    return 0;
+}
+
+// Renders the image, then again after every change to the file until interrupted.
+// The context stays alive in between, so buffers, palette tables and the export
+// font and surface are set up once; only the cells that changed are recomputed
+// and, in the terminal, sent. The directory is watched rather than the file, as
+// editors often replace a file instead of rewriting it.
+static int run_watch(asciiview_ctx_t* ctx, struct arguments* args, adaptive_t* adaptive) {
+    char* directory = strdup(args->filename);
+    if (!directory) return 1;
+    char* slash = strrchr(directory, '/');
+    const char* name = slash ? args->filename + (slash - directory) + 1 : args->filename;
+    if (!slash) strcpy(directory, ".");
+    else if (slash == directory) directory[1] = '\0';
+    else *slash = '\0';
+
+    int fd = inotify_init1(IN_CLOEXEC);
+    int watched = fd >= 0 && inotify_add_watch(fd, directory, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_MODIFY) >= 0;
+    if (!watched) {
+        fprintf(stderr, "Error: Could not watch %s for changes.\n", directory);
+        if (fd >= 0) close(fd);
+        free(directory);
+        return 1;
+    }
+    free(directory);
+
+    // Ctrl-C ends the session and prints the summary
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = on_interrupt;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    asciiview_set_incremental(ctx, 1);
+    latency_stats_t latency = {0};
+    render_watched(ctx, args, adaptive);
+    while (!interrupted) {
+        // Wait for a change, then until the writes have settled
+        double last_change = 0.0;
+        int pending = 0;
+        for (;;) {
+            int timeout = -1;
+            if (pending) {
+                timeout = (int) ((last_change - now_seconds()) * 1000.0) + WATCH_DEBOUNCE_MS;
+                if (timeout < 0) timeout = 0;
+            }
+            struct pollfd poll_fd = {fd, POLLIN, 0};
+            int ready = poll(&poll_fd, 1, timeout);
+            if (ready < 0 && errno == EINTR && !interrupted) continue;
+            if (ready <= 0) break;
+            if (read_watch_events(fd, name)) {
+                last_change = now_seconds();
+                pending = 1;
+            }
+        }
+        if (interrupted || !pending) break;
+
+        double start = now_seconds();
+        if (render_watched(ctx, args, adaptive) == 0) {
+            double end = now_seconds();
+            latency_stats_add(&latency, end - start);
+            fprintf(stderr, "Rendered in %.1f ms (%.1f ms after the last write)\n",
+                    (end - start) * 1000.0, (end - last_change) * 1000.0);
+        }
+    }
+
+    close(fd);
+    asciiview_flush_output(ctx);
+    latency_stats_print(&latency, "Re-render time", stderr);
+    return 0;
+}
 
 int main(int argc, char* argv[]) {
     // 1. Parse Arguments
     struct arguments args = parse_args(argc, argv);
+    if (args.print_cpu_info) {
+        fprintf(stderr, "Kernel path: %s\n", asciiview_cpu_path());
+    }
     if (args.filename == NULL) {
+        free(args.filenames);
         return 0; // Help was printed or invalid args
     }
 
-    // 2. Load Image
-    image_t original = load_image(args.filename);
-    if (!original.data) {
-        return 1; // Error printed inside load_image
-    }
+    asciiview_set_threads(args.threads);
 
-    // 3. Process Image (Create ASCII Grid)
-    // We pass the export options because they contain width/height/scale info
-    ascii_grid_t grid = process_image_to_grid(&original, &args.options);
-    
-    if (!grid.cells) {
-        fprintf(stderr, "Error: Failed to process image.\n");
-        free_image(&original);
+    asciiview_ctx_t* ctx = asciiview_create();
+    if (!ctx) {
+        fprintf(stderr, "Error: Failed to create conversion context.\n");
+        free(args.filenames);
         return 1;
     }
 
-    // 4. Output: Export OR Print
-    if (args.options.export_image) {
-        export_ascii_to_image(&grid, &args.options);
+    // Throughput-adaptive output (terminal only): measure the terminal up front
+    adaptive_t adaptive_state;
+    adaptive_t* adaptive = NULL;
+    int video = strcmp(args.filename, "-") == 0 && !args.transcode_path;
+    if (args.adaptive_ms > 0.0 && !args.options.export_image && !video && !args.transcode_path) {
+        adaptive = &adaptive_state;
+        adaptive_init(adaptive, args.adaptive_ms);
+        fflush(stdout);
+        if (adaptive_probe_terminal(adaptive, STDIN_FILENO, STDOUT_FILENO) != 0) {
+            fprintf(stderr, "Warning: Could not measure the terminal, adapting after the first frame.\n");
+        }
+    }
+
+    int status = 0;
+    animation_t animation = {0};
+    if (args.n_files == 1 && !args.options.export_image && !args.transcode_path && is_gif(args.filename)) {
+        animation = load_animation(args.filename);
+    }
+
+    if (args.transcode_path) {
+        // Offline video conversion
+        status = run_transcode(&args);
+    } else if (video) {
+        // Live video from stdin
+        if (args.options.export_image) {
+            fprintf(stderr, "Error: Video from stdin can only be shown in the terminal.\n");
+            status = 1;
+        } else {
+            status = run_video(ctx, &args);
+        }
+    } else if (animation.n_frames > 1) {
+        // Animated GIF in the terminal
+        status = play_animation(ctx, &args, &animation);
+    } else if (args.n_files > 1 && !args.options.export_image) {
+        // Slideshow in the terminal
+        status = run_slideshow(ctx, &args, adaptive);
+    } else if (asciivideo_probe(args.filename)) {
+        // ASCII video written by --transcode
+        if (args.options.export_image) {
+            fprintf(stderr, "Error: ASCII video files can only be played in the terminal.\n");
+            status = 1;
+        } else {
+            status = play_ascii_video(ctx, &args);
+        }
+    } else if (gridfile_probe(args.filename)) {
+        // Grid saved by an earlier run
+        status = show_grid_file(ctx, &args);
+    } else if (args.watch) {
+        // Re-render on every change to the file
+        status = run_watch(ctx, &args, adaptive);
     } else {
-        print_image(&grid);
+        if (args.n_files > 1) {
+            fprintf(stderr, "Warning: Exporting only the first image.\n");
+        }
+
+        // 2. Load Image
+        image_t original = load_source(&args, args.filename);
+        if (!original.data) {
+            status = 1; // Error printed inside load_source
+        } else if (args.interactive && !args.options.export_image) {
+            // 3. Explore the image: each view is converted on demand
+            status = run_viewer(ctx, &original, &args.options);
+            free_image(&original);
+        } else {
+            // 3. Process Image (Create ASCII Grid)
+            // We pass the export options because they contain width/height/scale info
+            export_options_t options;
+            size_t frame_bytes = 0;
+            ascii_grid_t grid = convert(ctx, &original, &args, adaptive, 0, &options, &frame_bytes);
+
+            if (!grid.chars) {
+                fprintf(stderr, "Error: Failed to process image.\n");
+                status = 1;
+            }
+            // 4. Output: Save the grid, Export OR Print
+            else if (args.grid_path) {
+                if (gridfile_write(args.grid_path, &grid, &options, args.grid_rle) != 0) status = 1;
+                if (options.export_image && asciiview_export(ctx, &options) != 0) status = 1;
+            }
+            else if (options.export_image) {
+                if (asciiview_export(ctx, &options) != 0) status = 1;
+            } else {
+                asciiview_print(ctx, &options);
+                if (options.sixel_preview && asciiview_print_sixel(ctx, &original, &options) != 0) {
+                    fprintf(stderr, "Error: Failed to print the Sixel preview.\n");
+                }
+                if (adaptive) adaptive_report(adaptive, &options, frame_bytes, stderr);
+            }
+            free_image(&original);
+        }
+    }
+
+    if (status == 0 && args.options.print_stats) {
+        asciiview_print_stats(ctx, stderr);
     }
 
     // 5. Cleanup
-    free_ascii_grid(&grid);
-    free_image(&original);
+    free_animation(&animation);
+    asciiview_destroy(ctx);
+    free(args.filenames);
     
     // Free allocated strings in options
     if (args.options.output_path) free(args.options.output_path);
     if (args.options.font_family) free(args.options.font_family);
+    free(args.transcode_path);
+    free(args.grid_path);
 
-    return 0;
-}
\ No newline at end of file
+    return status;
+}
@@ -0,0 +1,170 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#include "../include/output_queue.h"
+
+struct output_queue {
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;     // Any state change: submit, write done, stop
+    pthread_t thread;
+
+    term_writer_t* buffers;
+    size_t n_buffers;
+    size_t* free_list;          // Indices of empty buffers
+    size_t n_free;
+    size_t* pending;            // Ring of submitted buffer indices, oldest first
+    size_t pending_head;
+    size_t n_pending;
+    int writing;                // The thread holds a buffer outside both lists
+    int stop;
+    int error;
+
+    size_t n_stalls;
+    size_t bytes_written;
+    double write_seconds;
+};
+
+static void* writer_main(void* data) {
+    output_queue_t* queue = data;
+
+    pthread_mutex_lock(&queue->mutex);
+    for (;;) {
+        while (queue->n_pending == 0 && !queue->stop) {
+            pthread_cond_wait(&queue->changed, &queue->mutex);
+        }
+        if (queue->n_pending == 0) break; // Stopped and drained
+
+        size_t index = queue->pending[queue->pending_head];
+        queue->pending_head = (queue->pending_head + 1) % queue->n_buffers;
+        queue->n_pending--;
+        queue->writing = 1;
+
+        // Write without the lock: the producer keeps formatting meanwhile
+        pthread_mutex_unlock(&queue->mutex);
+        term_writer_t* buffer = &queue->buffers[index];
+        size_t length = buffer->length;
+        double seconds = buffer->write_seconds;
+        int status = term_writer_flush(buffer);
+        seconds = buffer->write_seconds - seconds;
+        pthread_mutex_lock(&queue->mutex);
+
+        if (status != 0) queue->error = 1;
+        else queue->bytes_written += length;
+        queue->write_seconds += seconds;
+        queue->writing = 0;
+        queue->free_list[queue->n_free++] = index;
+        pthread_cond_broadcast(&queue->changed);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    return NULL;
+}
+
+output_queue_t* output_queue_create(int fd, size_t n_buffers) {
+    if (n_buffers < 2) n_buffers = 2;
+
+    output_queue_t* queue = calloc(1, sizeof(*queue));
+    if (!queue) return NULL;
+    queue->buffers = calloc(n_buffers, sizeof(*queue->buffers));
+    queue->free_list = calloc(n_buffers, sizeof(*queue->free_list));
+    queue->pending = calloc(n_buffers, sizeof(*queue->pending));
+    if (!queue->buffers || !queue->free_list || !queue->pending) goto fail;
+
+    queue->n_buffers = n_buffers;
+    for (size_t i = 0; i < n_buffers; i++) {
+        term_writer_init(&queue->buffers[i], fd);
+        queue->free_list[queue->n_free++] = i;
+    }
+
+    pthread_mutex_init(&queue->mutex, NULL);
+    pthread_cond_init(&queue->changed, NULL);
+    if (pthread_create(&queue->thread, NULL, writer_main, queue) != 0) {
+        pthread_mutex_destroy(&queue->mutex);
+        pthread_cond_destroy(&queue->changed);
+        goto fail;
+    }
+    return queue;
+
+fail:
+    fprintf(stderr, "Error: Failed to start the output thread!\n");
+    free(queue->buffers);
+    free(queue->free_list);
+    free(queue->pending);
+    free(queue);
+    return NULL;
+}
+
+void output_queue_destroy(output_queue_t* queue) {
+    if (!queue) return;
+
+    pthread_mutex_lock(&queue->mutex);
+    queue->stop = 1;
+    pthread_cond_broadcast(&queue->changed);
+    pthread_mutex_unlock(&queue->mutex);
+    pthread_join(queue->thread, NULL);
+
+    for (size_t i = 0; i < queue->n_buffers; i++) {
+        term_writer_free(&queue->buffers[i]);
+    }
+    pthread_mutex_destroy(&queue->mutex);
+    pthread_cond_destroy(&queue->changed);
+    free(queue->buffers);
+    free(queue->free_list);
+    free(queue->pending);
+    free(queue);
+}
+
+term_writer_t* output_queue_acquire(output_queue_t* queue) {
+    pthread_mutex_lock(&queue->mutex);
+    if (queue->n_free == 0) queue->n_stalls++;
+    while (queue->n_free == 0) {
+        pthread_cond_wait(&queue->changed, &queue->mutex);
+    }
+    term_writer_t* buffer = &queue->buffers[queue->free_list[--queue->n_free]];
+    pthread_mutex_unlock(&queue->mutex);
+
+    buffer->length = 0;
+    return buffer;
+}
+
+void output_queue_submit(output_queue_t* queue, term_writer_t* buffer) {
+    size_t index = (size_t) (buffer - queue->buffers);
+
+    pthread_mutex_lock(&queue->mutex);
+    queue->pending[(queue->pending_head + queue->n_pending) % queue->n_buffers] = index;
+    queue->n_pending++;
+    pthread_cond_broadcast(&queue->changed);
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+int output_queue_drain(output_queue_t* queue) {
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->n_pending > 0 || queue->writing) {
+        pthread_cond_wait(&queue->changed, &queue->mutex);
+    }
+    int status = queue->error ? -1 : 0;
+    queue->error = 0;
+    pthread_mutex_unlock(&queue->mutex);
+    return status;
+}
+
+size_t output_queue_bytes_written(output_queue_t* queue) {
+    pthread_mutex_lock(&queue->mutex);
+    size_t bytes_written = queue->bytes_written;
+    pthread_mutex_unlock(&queue->mutex);
+    return bytes_written;
+}
+
+double output_queue_write_seconds(output_queue_t* queue) {
+    pthread_mutex_lock(&queue->mutex);
+    double write_seconds = queue->write_seconds;
+    pthread_mutex_unlock(&queue->mutex);
+    return write_seconds;
+}
+
+size_t output_queue_stalls(output_queue_t* queue) {
+    pthread_mutex_lock(&queue->mutex);
+    size_t n_stalls = queue->n_stalls;
+    pthread_mutex_unlock(&queue->mutex);
+    return n_stalls;
+}
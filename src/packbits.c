@@ -0,0 +1,56 @@
+#include <string.h>
+
+#include "../include/packbits.h"
+
+#define MAX_LITERALS 128
+#define MIN_REPEAT 3
+#define MAX_REPEAT 129
+
+size_t packbits_bound(size_t length) {
+    return length + (length + MAX_LITERALS - 1) / MAX_LITERALS;
+}
+
+size_t packbits_encode(const uint8_t* in, size_t length, uint8_t* out) {
+    size_t i = 0, n = 0;
+    while (i < length) {
+        size_t run = 1;
+        while (i + run < length && run < MAX_REPEAT && in[i + run] == in[i]) run++;
+        if (run >= MIN_REPEAT) {
+            out[n++] = (uint8_t) (run + 125);
+            out[n++] = in[i];
+            i += run;
+            continue;
+        }
+
+        // Literals up to the next repeat
+        size_t start = i;
+        while (i < length && i - start < MAX_LITERALS) {
+            if (i + 2 < length && in[i] == in[i + 1] && in[i] == in[i + 2]) break;
+            i++;
+        }
+        out[n++] = (uint8_t) (i - start - 1);
+        memcpy(&out[n], &in[start], i - start);
+        n += i - start;
+    }
+    return n;
+}
+
+int packbits_decode(const uint8_t* in, size_t size, uint8_t* out, size_t length) {
+    size_t i = 0, n = 0;
+    while (i < size) {
+        uint8_t control = in[i++];
+        if (control < 128) {
+            size_t count = (size_t) control + 1;
+            if (i + count > size || n + count > length) return -1;
+            memcpy(&out[n], &in[i], count);
+            i += count;
+            n += count;
+        } else {
+            size_t count = (size_t) control - 125;
+            if (i >= size || n + count > length) return -1;
+            memset(&out[n], in[i++], count);
+            n += count;
+        }
+    }
+    return n == length ? 0 : -1;
+}
@@ -0,0 +1,242 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../include/palette.h"
+#include "../include/threadpool.h"
+
+#define LUT_SIDE (1 << COLOR_LUT_BITS)
+#define MIN_PIXELS_PER_SLICE 32768
+#define LUT_KEYS_PER_TASK 1024
+
+// --- Histogram ---
+
+typedef struct {
+    const uint8_t *r, *g, *b;
+    size_t stride;
+    size_t slice_size;
+    uint32_t* histograms; // One COLOR_LUT_SIZE histogram per slice
+} histogram_job_t;
+
+static void histogram_slice(void* arg, size_t begin, size_t end) {
+    histogram_job_t* job = arg;
+    uint32_t* histogram = &job->histograms[(begin / job->slice_size) * COLOR_LUT_SIZE];
+    for (size_t i = begin; i < end; i++) {
+        size_t k = i * job->stride;
+        histogram[COLOR_LUT_KEY(job->r[k], job->g[k], job->b[k])]++;
+    }
+}
+
+// --- Median Cut ---
+
+typedef struct {
+    int lo[3];
+    int hi[3];
+    uint64_t count;
+} box_t;
+
+static size_t bin_index(int r, int g, int b) {
+    return ((size_t) r << (2 * COLOR_LUT_BITS)) | ((size_t) g << COLOR_LUT_BITS) | (size_t) b;
+}
+
+// Shrinks box to the bounds of its non-empty bins and recounts it
+static void shrink_box(box_t* box, const uint32_t* histogram) {
+    int lo[3] = {LUT_SIDE, LUT_SIDE, LUT_SIDE};
+    int hi[3] = {-1, -1, -1};
+    uint64_t count = 0;
+
+    for (int r = box->lo[0]; r <= box->hi[0]; r++) {
+        for (int g = box->lo[1]; g <= box->hi[1]; g++) {
+            for (int b = box->lo[2]; b <= box->hi[2]; b++) {
+                uint32_t n = histogram[bin_index(r, g, b)];
+                if (!n) continue;
+                int v[3] = {r, g, b};
+                for (int c = 0; c < 3; c++) {
+                    if (v[c] < lo[c]) lo[c] = v[c];
+                    if (v[c] > hi[c]) hi[c] = v[c];
+                }
+                count += n;
+            }
+        }
+    }
+
+    box->count = count;
+    if (count == 0) return;
+    memcpy(box->lo, lo, sizeof(lo));
+    memcpy(box->hi, hi, sizeof(hi));
+}
+
+static int longest_axis(const box_t* box) {
+    int axis = 0;
+    for (int c = 1; c < 3; c++) {
+        if (box->hi[c] - box->lo[c] > box->hi[axis] - box->lo[axis]) axis = c;
+    }
+    return axis;
+}
+
+// Splits `box` at the population median of its longest axis; the upper half goes to `out`
+static void split_box(box_t* box, box_t* out, const uint32_t* histogram) {
+    int axis = longest_axis(box);
+    uint64_t slab[LUT_SIDE] = {0};
+
+    for (int r = box->lo[0]; r <= box->hi[0]; r++) {
+        for (int g = box->lo[1]; g <= box->hi[1]; g++) {
+            for (int b = box->lo[2]; b <= box->hi[2]; b++) {
+                int v[3] = {r, g, b};
+                slab[v[axis]] += histogram[bin_index(r, g, b)];
+            }
+        }
+    }
+
+    int cut = box->lo[axis];
+    uint64_t running = slab[cut];
+    while (cut + 1 < box->hi[axis] && running < box->count / 2) {
+        running += slab[++cut];
+    }
+
+    *out = *box;
+    box->hi[axis] = cut;
+    out->lo[axis] = cut + 1;
+    shrink_box(box, histogram);
+    shrink_box(out, histogram);
+}
+
+static void box_average(const box_t* box, const uint32_t* histogram, uint8_t* color) {
+    uint64_t sum[3] = {0, 0, 0};
+    int shift = 8 - COLOR_LUT_BITS;
+    int half = (1 << shift) / 2;
+
+    for (int r = box->lo[0]; r <= box->hi[0]; r++) {
+        for (int g = box->lo[1]; g <= box->hi[1]; g++) {
+            for (int b = box->lo[2]; b <= box->hi[2]; b++) {
+                uint32_t n = histogram[bin_index(r, g, b)];
+                sum[0] += (uint64_t) n * ((r << shift) + half);
+                sum[1] += (uint64_t) n * ((g << shift) + half);
+                sum[2] += (uint64_t) n * ((b << shift) + half);
+            }
+        }
+    }
+    for (int c = 0; c < 3; c++) {
+        color[c] = (uint8_t) ((sum[c] + box->count / 2) / box->count);
+    }
+}
+
+static size_t median_cut(const uint32_t* histogram, size_t max_colors, uint8_t (*colors)[3]) {
+    box_t boxes[PALETTE_MAX_COLORS];
+    size_t n_boxes = 1;
+
+    boxes[0] = (box_t) {{0, 0, 0}, {LUT_SIDE - 1, LUT_SIDE - 1, LUT_SIDE - 1}, 0};
+    shrink_box(&boxes[0], histogram);
+    if (boxes[0].count == 0) return 0;
+
+    while (n_boxes < max_colors) {
+        // Split the box with the largest population-weighted extent
+        size_t best = n_boxes;
+        uint64_t best_score = 0;
+        for (size_t i = 0; i < n_boxes; i++) {
+            int axis = longest_axis(&boxes[i]);
+            uint64_t score = boxes[i].count * (uint64_t) (boxes[i].hi[axis] - boxes[i].lo[axis]);
+            if (score > best_score) {
+                best_score = score;
+                best = i;
+            }
+        }
+        if (best == n_boxes) break; // Every box is a single bin
+
+        split_box(&boxes[best], &boxes[n_boxes], histogram);
+        n_boxes++;
+    }
+
+    for (size_t i = 0; i < n_boxes; i++) {
+        box_average(&boxes[i], histogram, colors[i]);
+    }
+    return n_boxes;
+}
+
+// --- Lookup Table ---
+
+static void lut_slice(void* arg, size_t begin, size_t end) {
+    palette_t* palette = arg;
+    int shift = 8 - COLOR_LUT_BITS;
+    int half = (1 << shift) / 2;
+
+    for (size_t key = begin; key < end; key++) {
+        int r = (int) ((key >> (2 * COLOR_LUT_BITS)) << shift) + half;
+        int g = (int) (((key >> COLOR_LUT_BITS) & (LUT_SIDE - 1)) << shift) + half;
+        int b = (int) ((key & (LUT_SIDE - 1)) << shift) + half;
+
+        size_t best = 0;
+        int best_distance = 1 << 30;
+        for (size_t i = 0; i < palette->n_colors; i++) {
+            int dr = r - palette->colors[i][0];
+            int dg = g - palette->colors[i][1];
+            int db = b - palette->colors[i][2];
+            int distance = dr * dr + dg * dg + db * db;
+            if (distance < best_distance) {
+                best_distance = distance;
+                best = i;
+            }
+        }
+        palette->lut[key] = (uint8_t) best;
+    }
+}
+
+int palette_build_lut(palette_t* palette, arena_t* arena) {
+    if (!palette->lut) {
+        palette->lut = arena ? arena_alloc(arena, COLOR_LUT_SIZE) : malloc(COLOR_LUT_SIZE);
+        if (!palette->lut) {
+            fprintf(stderr, "Error: Failed to allocate memory for palette lookup table!\n");
+            return -1;
+        }
+    }
+    if (palette->n_colors == 0) {
+        memset(palette->lut, 0, COLOR_LUT_SIZE);
+        return 0;
+    }
+
+    parallel_for(COLOR_LUT_SIZE, LUT_KEYS_PER_TASK, lut_slice, palette);
+    return 0;
+}
+
+int palette_build(palette_t* palette, const uint8_t* r, const uint8_t* g, const uint8_t* b,
+                  size_t n_pixels, size_t stride, size_t max_colors, arena_t* arena) {
+    if (max_colors < 1) max_colors = 1;
+    if (max_colors > PALETTE_MAX_COLORS) max_colors = PALETTE_MAX_COLORS;
+
+    // One private histogram per slice, merged afterwards
+    size_t n_slices = threadpool_size();
+    if (n_slices > n_pixels / MIN_PIXELS_PER_SLICE) n_slices = n_pixels / MIN_PIXELS_PER_SLICE;
+    if (n_slices < 1) n_slices = 1;
+    size_t slice_size = (n_pixels + n_slices - 1) / n_slices;
+    if (slice_size < 1) slice_size = 1;
+    uint32_t* histograms = arena ? arena_calloc(arena, n_slices * COLOR_LUT_SIZE, sizeof(*histograms))
+                                 : calloc(n_slices * COLOR_LUT_SIZE, sizeof(*histograms));
+    if (!histograms) {
+        fprintf(stderr, "Error: Failed to allocate memory for palette histogram!\n");
+        return -1;
+    }
+
+    histogram_job_t job = {r, g, b, stride, slice_size, histograms};
+    parallel_for(n_pixels, slice_size, histogram_slice, &job);
+
+    // Merge per-slice histograms into the first one
+    for (size_t s = 1; s < n_slices; s++) {
+        const uint32_t* local = &histograms[s * COLOR_LUT_SIZE];
+        for (size_t i = 0; i < COLOR_LUT_SIZE; i++) {
+            histograms[i] += local[i];
+        }
+    }
+
+    palette->n_colors = median_cut(histograms, max_colors, palette->colors);
+    if (!arena) free(histograms);
+
+    return palette_build_lut(palette, arena);
+}
+
+void free_palette(palette_t* palette) {
+    if (palette) {
+        free(palette->lut);
+        palette->lut = NULL;
+        palette->n_colors = 0;
+    }
+}
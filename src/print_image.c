@@ -1,19 +1,382 @@
 #include <stdio.h>
+#include <pthread.h>
+#include <unistd.h>
 #include "../include/print_image.h"
 #include "../include/image.h"
+#include "../include/palette.h"
 
 #define RESET "\x1b[0m"
 
-void print_image(ascii_grid_t* grid) {
-    if (!grid || !grid->cells) return;
+// Longest cell: "\x1b[38;2;255;255;255m" + character
+#define MAX_CELL_BYTES 20
+// Longest glyph cell: foreground and background escapes + 3-byte UTF-8 glyph
+#define MAX_GLYPH_CELL_BYTES (2 * (MAX_CELL_BYTES - 1) + 4)
+
+// Differential redraw
+#define SYNC_BEGIN "\x1b[?2026h"     // Synchronized output: the terminal shows the frame at once
+#define SYNC_END "\x1b[?2026l"
+#define CLEAR_SCREEN "\x1b[H\x1b[2J"
+#define MAX_CURSOR_BYTES 44          // "\x1b[<row>;<col>H"
+// Unchanged cells shorter than this between two changed spans are resent rather
+// than skipped with a cursor move
+#define SPAN_MERGE_GAP 4
+
+// xterm-256 entries 0-15 depend on the terminal theme: only the cube and the gray ramp are used
+#define XTERM_FIRST_FIXED 16
+
+// --- Indexed Palettes ---
+
+static palette_t xterm_palette;
+static palette_t ansi_palette;
+static pthread_once_t palettes_once = PTHREAD_ONCE_INIT;
+static int palettes_ready = 0;
+
+// Default xterm values of the 16 ANSI colors
+static const uint8_t ansi_colors[16][3] = {
+    {0, 0, 0}, {205, 0, 0}, {0, 205, 0}, {205, 205, 0},
+    {0, 0, 238}, {205, 0, 205}, {0, 205, 205}, {229, 229, 229},
+    {127, 127, 127}, {255, 0, 0}, {0, 255, 0}, {255, 255, 0},
+    {92, 92, 255}, {255, 0, 255}, {0, 255, 255}, {255, 255, 255}
+};
+
+// Both lookup tables are built once per process and shared by every render
+static void build_palettes(void) {
+    static const uint8_t cube[6] = {0, 95, 135, 175, 215, 255};
+    size_t n = 0;
+
+    // 6x6x6 color cube (16-231)
+    for (int r = 0; r < 6; r++) {
+        for (int g = 0; g < 6; g++) {
+            for (int b = 0; b < 6; b++) {
+                xterm_palette.colors[n][0] = cube[r];
+                xterm_palette.colors[n][1] = cube[g];
+                xterm_palette.colors[n][2] = cube[b];
+                n++;
+            }
+        }
+    }
+    // Gray ramp (232-255)
+    for (int i = 0; i < 24; i++) {
+        uint8_t v = (uint8_t) (8 + 10 * i);
+        xterm_palette.colors[n][0] = xterm_palette.colors[n][1] = xterm_palette.colors[n][2] = v;
+        n++;
+    }
+    xterm_palette.n_colors = n;
+
+    for (size_t i = 0; i < 16; i++) {
+        for (int c = 0; c < 3; c++) ansi_palette.colors[i][c] = ansi_colors[i][c];
+    }
+    ansi_palette.n_colors = 16;
+
+    palettes_ready = palette_build_lut(&xterm_palette, NULL) == 0 &&
+                     palette_build_lut(&ansi_palette, NULL) == 0;
+}
+
+// --- Rendering ---
+
+// Squared "redmean" distance: a cheap perceptual approximation of color difference,
+// scaled so that 1.0 matches one step of plain RGB Euclidean distance.
+static double color_distance_sq(int r1, int g1, int b1, int r2, int g2, int b2) {
+    double mean_r = (r1 + r2) / 2.0;
+    double dr = r1 - r2, dg = g1 - g2, db = b1 - b2;
+    return ((2.0 + mean_r / 256.0) * dr * dr + 4.0 * dg * dg + (2.0 + (255.0 - mean_r) / 256.0) * db * db) / 3.0;
+}
+
+static void put_glyph(term_writer_t* out, const ascii_grid_t* grid, size_t idx) {
+    if (grid->glyphs) {
+        out->length += glyph_to_utf8(grid->glyphs[idx], out->data + out->length);
+    } else {
+        term_put_char(out, grid->chars[idx]);
+    }
+}
+
+// Current color of one layer (foreground or background) along a line
+typedef struct {
+    int r, g, b; // -1: none yet (start of a line, after RESET)
+} color_run_t;
+
+// Emits "\x1b[<layer>;2;r;g;bm" unless the color matches the run (within tolerance)
+static void put_truecolor(term_writer_t* out, color_run_t* run, char layer, int r, int g, int b, double tolerance_sq) {
+    // Same color as the run (or close enough): the terminal keeps the current one
+    int same = (r == run->r && g == run->g && b == run->b);
+    if (!same && tolerance_sq > 0.0 && run->r >= 0) {
+        same = color_distance_sq(r, g, b, run->r, run->g, run->b) < tolerance_sq;
+    }
+    if (same) return;
+
+    // Print using TrueColor ANSI
+    term_put_literal(out, "\x1b[");
+    term_put_char(out, layer);
+    term_put_literal(out, "8;2;");
+    term_put_u8(out, (uint8_t) r);
+    term_put_char(out, ';');
+    term_put_u8(out, (uint8_t) g);
+    term_put_char(out, ';');
+    term_put_u8(out, (uint8_t) b);
+    term_put_char(out, 'm');
+    run->r = r; run->g = g; run->b = b;
+}
+
+static void render_truecolor(ascii_grid_t* grid, double tolerance, term_writer_t* out) {
+    double tolerance_sq = tolerance * tolerance;
 
     for (size_t y = 0; y < grid->height; y++) {
+        color_run_t fg = {-1, -1, -1}, bg = {-1, -1, -1};
+
         for (size_t x = 0; x < grid->width; x++) {
-            ascii_cell_t* cell = &grid->cells[y * grid->width + x];
-            
-            // Print using TrueColor ANSI
-            printf("\x1b[38;2;%d;%d;%dm%c", cell->r, cell->g, cell->b, cell->character);
+            size_t idx = y * grid->width + x;
+            put_truecolor(out, &fg, '3', grid->r[idx], grid->g[idx], grid->b[idx], tolerance_sq);
+            if (grid->bg_r) {
+                put_truecolor(out, &bg, '4', grid->bg_r[idx], grid->bg_g[idx], grid->bg_b[idx], tolerance_sq);
+            }
+            put_glyph(out, grid, idx);
+        }
+        term_put_literal(out, RESET "\n");
+    }
+}
+
+// Emits the indexed color escape of one layer unless `index` matches the run
+static void put_indexed(term_writer_t* out, int* run, int background, int index, color_mode_t mode) {
+    if (index == *run) return;
+
+    if (mode == COLOR_MODE_256) {
+        term_put_literal(out, "\x1b[");
+        term_put_char(out, background ? '4' : '3');
+        term_put_literal(out, "8;5;");
+        term_put_u8(out, (uint8_t) (XTERM_FIRST_FIXED + index));
+        term_put_char(out, 'm');
+    } else {
+        // Foreground 30-37 normal, 90-97 bright; background 40-47, 100-107
+        term_put_literal(out, "\x1b[");
+        if (index < 8) {
+            term_put_char(out, background ? '4' : '3');
+        } else if (background) {
+            term_put_literal(out, "10");
+        } else {
+            term_put_char(out, '9');
         }
-        printf("%s\n", RESET);
+        term_put_char(out, (char) ('0' + (index & 7)));
+        term_put_char(out, 'm');
+    }
+    *run = index;
+}
+
+static void render_indexed(ascii_grid_t* grid, color_mode_t mode, term_writer_t* out) {
+    const palette_t* palette = (mode == COLOR_MODE_256) ? &xterm_palette : &ansi_palette;
+
+    for (size_t y = 0; y < grid->height; y++) {
+        int fg = -1, bg = -1;
+
+        for (size_t x = 0; x < grid->width; x++) {
+            size_t idx = y * grid->width + x;
+            put_indexed(out, &fg, 0, palette_lookup(palette, grid->r[idx], grid->g[idx], grid->b[idx]), mode);
+            if (grid->bg_r) {
+                put_indexed(out, &bg, 1, palette_lookup(palette, grid->bg_r[idx], grid->bg_g[idx], grid->bg_b[idx]), mode);
+            }
+            put_glyph(out, grid, idx);
+        }
+        term_put_literal(out, RESET "\n");
+    }
+}
+
+static void render_plain(ascii_grid_t* grid, term_writer_t* out) {
+    for (size_t y = 0; y < grid->height; y++) {
+        if (grid->glyphs) {
+            for (size_t x = 0; x < grid->width; x++) put_glyph(out, grid, y * grid->width + x);
+        } else {
+            term_put_bytes(out, &grid->chars[y * grid->width], grid->width);
+        }
+        term_put_char(out, '\n');
+    }
+}
+
+int render_image(ascii_grid_t* grid, const export_options_t* options, term_writer_t* out) {
+    if (!grid || !grid->chars) return 0;
+
+    color_mode_t mode = options ? options->color_mode : COLOR_MODE_TRUE;
+    if (mode == COLOR_MODE_256 || mode == COLOR_MODE_16) {
+        pthread_once(&palettes_once, build_palettes);
+        if (!palettes_ready) return -1;
+    }
+
+    size_t row_bytes = grid->width * (grid->glyphs ? MAX_GLYPH_CELL_BYTES : MAX_CELL_BYTES) + sizeof(RESET);
+    if (term_writer_reserve(out, grid->height * row_bytes) != 0) return -1;
+
+    switch (mode) {
+        case COLOR_MODE_256:
+        case COLOR_MODE_16:
+            render_indexed(grid, mode, out);
+            break;
+        case COLOR_MODE_NONE:
+            render_plain(grid, out);
+            break;
+        default:
+            render_truecolor(grid, (options && options->color_tolerance > 0.0) ? options->color_tolerance : 0.0, out);
+            break;
+    }
+    return 0;
+}
+
+// --- Differential Redraw ---
+
+static int cells_equal(const ascii_grid_t* a, const ascii_grid_t* b, size_t idx) {
+    if (a->chars[idx] != b->chars[idx] || a->r[idx] != b->r[idx] || a->g[idx] != b->g[idx] || a->b[idx] != b->b[idx]) {
+        return 0;
+    }
+    if (a->glyphs && a->glyphs[idx] != b->glyphs[idx]) return 0;
+    if (a->bg_r && (a->bg_r[idx] != b->bg_r[idx] || a->bg_g[idx] != b->bg_g[idx] || a->bg_b[idx] != b->bg_b[idx])) {
+        return 0;
+    }
+    return 1;
+}
+
+// Same dimensions and planes: cells can be compared one by one
+static int same_layout(const ascii_grid_t* a, const ascii_grid_t* b) {
+    return a->width == b->width && a->height == b->height &&
+           (a->glyphs != NULL) == (b->glyphs != NULL) && (a->bg_r != NULL) == (b->bg_r != NULL);
+}
+
+typedef struct {
+    color_mode_t mode;
+    const palette_t* palette;
+    double tolerance_sq;
+    color_run_t fg, bg;     // TrueColor runs
+    int fg_index, bg_index; // Indexed runs
+} cell_state_t;
+
+static void put_cell(term_writer_t* out, const ascii_grid_t* grid, size_t idx, cell_state_t* state) {
+    switch (state->mode) {
+        case COLOR_MODE_256:
+        case COLOR_MODE_16:
+            put_indexed(out, &state->fg_index, 0, palette_lookup(state->palette, grid->r[idx], grid->g[idx], grid->b[idx]), state->mode);
+            if (grid->bg_r) {
+                put_indexed(out, &state->bg_index, 1,
+                            palette_lookup(state->palette, grid->bg_r[idx], grid->bg_g[idx], grid->bg_b[idx]), state->mode);
+            }
+            break;
+        case COLOR_MODE_NONE:
+            break;
+        default:
+            put_truecolor(out, &state->fg, '3', grid->r[idx], grid->g[idx], grid->b[idx], state->tolerance_sq);
+            if (grid->bg_r) {
+                put_truecolor(out, &state->bg, '4', grid->bg_r[idx], grid->bg_g[idx], grid->bg_b[idx], state->tolerance_sq);
+            }
+            break;
+    }
+    put_glyph(out, grid, idx);
+}
+
+static void put_cursor(term_writer_t* out, size_t row, size_t col) {
+    term_put_literal(out, "\x1b[");
+    term_put_uint(out, row + 1);
+    term_put_char(out, ';');
+    term_put_uint(out, col + 1);
+    term_put_char(out, 'H');
+}
+
+static int init_cell_state(cell_state_t* state, const export_options_t* options) {
+    *state = (cell_state_t) {0};
+    state->mode = options ? options->color_mode : COLOR_MODE_TRUE;
+    if (state->mode == COLOR_MODE_256 || state->mode == COLOR_MODE_16) {
+        pthread_once(&palettes_once, build_palettes);
+        if (!palettes_ready) return -1;
+        state->palette = (state->mode == COLOR_MODE_256) ? &xterm_palette : &ansi_palette;
+    }
+    if (state->mode == COLOR_MODE_TRUE && options && options->color_tolerance > 0.0) {
+        state->tolerance_sq = options->color_tolerance * options->color_tolerance;
+    }
+    // Colors carry over between spans: the terminal keeps them across cursor moves
+    state->fg = state->bg = (color_run_t) {-1, -1, -1};
+    state->fg_index = state->bg_index = -1;
+    return 0;
+}
+
+int render_image_diff(ascii_grid_t* grid, const ascii_grid_t* previous, const export_options_t* options,
+                      term_writer_t* out) {
+    if (!grid || !grid->chars) return 0;
+
+    cell_state_t state;
+    if (init_cell_state(&state, options) != 0) return -1;
+
+    // Worst case: every other cell changed, one cursor move per changed cell
+    size_t cell_bytes = grid->glyphs ? MAX_GLYPH_CELL_BYTES : MAX_CELL_BYTES;
+    size_t row_bytes = grid->width * cell_bytes + (grid->width / 2 + 1) * MAX_CURSOR_BYTES;
+    size_t frame_bytes = sizeof(SYNC_BEGIN CLEAR_SCREEN RESET SYNC_END) + MAX_CURSOR_BYTES;
+    if (term_writer_reserve(out, grid->height * row_bytes + frame_bytes) != 0) return -1;
+
+    int full = !previous || !previous->chars || !same_layout(grid, previous);
+    term_put_literal(out, SYNC_BEGIN);
+    if (full) term_put_literal(out, CLEAR_SCREEN);
+
+    for (size_t y = 0; y < grid->height; y++) {
+        size_t row = y * grid->width;
+        size_t x = 0;
+
+        while (x < grid->width) {
+            // Next changed cell
+            while (x < grid->width && !full && cells_equal(grid, previous, row + x)) x++;
+            if (x == grid->width) break;
+
+            // Extend the span over changed cells and short unchanged gaps
+            size_t span_end = x + 1;
+            size_t gap = 0;
+            for (size_t i = x + 1; i < grid->width && gap < SPAN_MERGE_GAP; i++) {
+                if (full || !cells_equal(grid, previous, row + i)) {
+                    span_end = i + 1;
+                    gap = 0;
+                } else {
+                    gap++;
+                }
+            }
+
+            put_cursor(out, y, x);
+            for (size_t i = x; i < span_end; i++) put_cell(out, grid, row + i, &state);
+            x = span_end;
+        }
+    }
+
+    // Leave the cursor below the image
+    term_put_literal(out, RESET);
+    put_cursor(out, grid->height, 0);
+    term_put_literal(out, SYNC_END);
+    return 0;
+}
+
+int render_image_spans(const ascii_grid_t* grid, const grid_span_t* spans, size_t n_spans, int clear,
+                       const export_options_t* options, term_writer_t* out) {
+    if (!grid || !grid->chars) return 0;
+
+    cell_state_t state;
+    if (init_cell_state(&state, options) != 0) return -1;
+
+    size_t n_cells = 0;
+    for (size_t s = 0; s < n_spans; s++) n_cells += spans[s].length;
+    size_t cell_bytes = grid->glyphs ? MAX_GLYPH_CELL_BYTES : MAX_CELL_BYTES;
+    size_t frame_bytes = sizeof(SYNC_BEGIN CLEAR_SCREEN RESET SYNC_END) + MAX_CURSOR_BYTES;
+    if (term_writer_reserve(out, n_cells * cell_bytes + n_spans * MAX_CURSOR_BYTES + frame_bytes) != 0) return -1;
+
+    term_put_literal(out, SYNC_BEGIN);
+    if (clear) term_put_literal(out, CLEAR_SCREEN);
+    for (size_t s = 0; s < n_spans; s++) {
+        put_cursor(out, spans[s].start / grid->width, spans[s].start % grid->width);
+        for (size_t i = spans[s].start; i < spans[s].start + spans[s].length; i++) put_cell(out, grid, i, &state);
+    }
+    term_put_literal(out, RESET);
+    put_cursor(out, grid->height, 0);
+    term_put_literal(out, SYNC_END);
+    return 0;
+}
+
+void print_image(ascii_grid_t* grid, const export_options_t* options) {
+    if (!grid || !grid->chars) return;
+
+    term_writer_t out;
+    term_writer_init(&out, STDOUT_FILENO);
+
+    // Anything already queued in stdio must come first
+    fflush(stdout);
+    if (render_image(grid, options, &out) == 0) {
+        term_writer_flush(&out);
     }
-}
\ No newline at end of file
+    term_writer_free(&out);
+}
@@ -1,14 +1,23 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 #include "../include/process.h"
 #include "../include/image.h"
+#include "../include/palette.h"
+#include "../include/threadpool.h"
+#include "../include/cpu_dispatch.h"
 
 // --- Constants & Helpers ---
 #define VALUE_CHARS " .-=+*x#$&X@"
 #define N_VALUES (sizeof(VALUE_CHARS) - 1) 
 #define DEFAULT_EDGE_THRESHOLD 4.0
 #define DEFAULT_CHAR_RATIO 2.0
+#define ROWS_PER_TASK 8
+
+// Unicode glyphs of the high-density modes
+#define UPPER_HALF_BLOCK 0x2580
+#define BRAILLE_BASE 0x2800
 
 // HSV Helpers (omitted for brevity, same as before but I need to include them for compilation)
 typedef struct { double hue; double saturation; double value; } hsv_t;
@@ -62,12 +71,242 @@ static char get_sobel_angle_char(double sobel_angle) {
     else return '|';
 }
 
-// --- Main Processing Function ---
+// --- Fill Loop ---
 
-ascii_grid_t process_image_to_grid(image_t* original, export_options_t* options) {
-    ascii_grid_t grid = {0};
-    if (!original || !original->data) return grid;
+typedef struct {
+    ascii_grid_t* grid;
+    image_t* resized;
+    const double* sobel_x;
+    const double* sobel_y;
+    double edge_threshold;
+    const uint8_t* mask;    // If not NULL, only cells with a non-zero entry are filled
+} fill_job_t;
+
+// Body shared by every fill variant. The mode flags are compile-time constants at
+// each instantiation below, so the branches on them fold away and each variant is
+// straight-line code over the row band [row_begin, row_end).
+__attribute__((always_inline))
+static inline void fill_rows_body(fill_job_t* job, size_t row_begin, size_t row_end,
+                                  const int is_gray, const int use_retro_colors, const int use_edges) {
+    ascii_grid_t* grid = job->grid;
+    image_t* resized = job->resized;
+    size_t channels = resized->channels;
+    const uint8_t* mask = job->mask;
+
+    for (size_t y = row_begin; y < row_end; y++) {
+        const double* pixel = get_pixel(resized, 0, y);
+        for (size_t x = 0; x < grid->width; x++, pixel += channels) {
+            size_t idx = y * grid->width + x;
+            if (mask && !mask[idx]) continue;
+            
+            double r_d, g_d, b_d;
+            double val_grayscale;
+            
+            if (is_gray) {
+                 val_grayscale = pixel[0];
+                 r_d = g_d = b_d = pixel[0];
+            } else {
+                hsv_t hsv = rgb_to_hsv(pixel[0], pixel[1], pixel[2]);
+                val_grayscale = calculate_grayscale_from_hsv(&hsv);
+                if (use_retro_colors) get_retro_rgb(&hsv, &r_d, &g_d, &b_d);
+                else { hsv.value = 1.0; hsv_to_rgb(&hsv, &r_d, &g_d, &b_d); }
+            }
+            
+            grid->r[idx] = (uint8_t)(r_d * 255); grid->g[idx] = (uint8_t)(g_d * 255); grid->b[idx] = (uint8_t)(b_d * 255);
+            grid->chars[idx] = get_ascii_char(val_grayscale);
+        }
+    }
+
+    if (!use_edges) return;
+
+    // Edge characters override value characters. Sobel planes share the grid layout.
+    const double* sobel_x = job->sobel_x;
+    const double* sobel_y = job->sobel_y;
+    double edge_threshold = job->edge_threshold;
+    for (size_t idx = row_begin * grid->width; idx < row_end * grid->width; idx++) {
+        if (mask && !mask[idx]) continue;
+        if ((sobel_x[idx]*sobel_x[idx] + sobel_y[idx]*sobel_y[idx]) >= edge_threshold * edge_threshold) {
+            grid->chars[idx] = get_sobel_angle_char(atan2(sobel_y[idx], sobel_x[idx]) * 180. / M_PI);
+        }
+    }
+}
+
+#define DEFINE_FILL_VARIANT(name, is_gray, use_retro_colors, use_edges) \
+    HOT_KERNEL static void name(void* arg, size_t row_begin, size_t row_end) { \
+        fill_rows_body(arg, row_begin, row_end, is_gray, use_retro_colors, use_edges); \
+    }
+
+DEFINE_FILL_VARIANT(fill_gray,             1, 0, 0)
+DEFINE_FILL_VARIANT(fill_gray_edges,       1, 0, 1)
+DEFINE_FILL_VARIANT(fill_rgb,              0, 0, 0)
+DEFINE_FILL_VARIANT(fill_rgb_edges,        0, 0, 1)
+DEFINE_FILL_VARIANT(fill_retro,            0, 1, 0)
+DEFINE_FILL_VARIANT(fill_retro_edges,      0, 1, 1)
+
+// Indexed by [is_gray][use_retro_colors][use_edges]. Gray images have no hue to quantize.
+static const task_fn fill_variants[2][2][2] = {
+    {{fill_rgb, fill_rgb_edges}, {fill_retro, fill_retro_edges}},
+    {{fill_gray, fill_gray_edges}, {fill_gray, fill_gray_edges}},
+};
+
+// --- High-Density Fill (half blocks / braille) ---
+// Here the resized image has several samples per cell: 1x2 for half blocks,
+// 2x4 for braille. Samples past the last row or column repeat the last one.
+
+typedef struct {
+    ascii_grid_t* grid;
+    image_t* resized;
+    int is_gray;
+    int use_retro_colors;
+    const uint8_t* mask;    // If not NULL, only cells with a non-zero entry are filled
+} glyph_job_t;
+
+static const double* get_sample(image_t* resized, size_t x, size_t y) {
+    if (x >= resized->width) x = resized->width - 1;
+    if (y >= resized->height) y = resized->height - 1;
+    return get_pixel(resized, x, y);
+}
+
+static void sample_rgb(const double* pixel, int is_gray, double* r, double* g, double* b) {
+    if (is_gray) {
+        *r = *g = *b = pixel[0];
+    } else {
+        *r = pixel[0]; *g = pixel[1]; *b = pixel[2];
+    }
+}
+
+static double sample_grayscale(const double* pixel, int is_gray) {
+    if (is_gray) return pixel[0];
+    hsv_t hsv = rgb_to_hsv(pixel[0], pixel[1], pixel[2]);
+    return calculate_grayscale_from_hsv(&hsv);
+}
+
+// Retro colors for samples that keep their brightness: each channel on or off (3 bits)
+static uint8_t retro_channel(double value) {
+    return value >= 0.5 ? 255 : 0;
+}
+
+// Upper half block: the top sample is the foreground color, the bottom one the background
+HOT_KERNEL
+static void fill_half(void* arg, size_t row_begin, size_t row_end) {
+    glyph_job_t* job = arg;
+    ascii_grid_t* grid = job->grid;
+    image_t* resized = job->resized;
+
+    for (size_t y = row_begin; y < row_end; y++) {
+        for (size_t x = 0; x < grid->width; x++) {
+            size_t idx = y * grid->width + x;
+            if (job->mask && !job->mask[idx]) continue;
+            const double* top = get_sample(resized, x, 2 * y);
+            const double* bottom = get_sample(resized, x, 2 * y + 1);
+
+            double r, g, b;
+            sample_rgb(top, job->is_gray, &r, &g, &b);
+            if (job->use_retro_colors) {
+                grid->r[idx] = retro_channel(r); grid->g[idx] = retro_channel(g); grid->b[idx] = retro_channel(b);
+            } else {
+                grid->r[idx] = (uint8_t)(r * 255); grid->g[idx] = (uint8_t)(g * 255); grid->b[idx] = (uint8_t)(b * 255);
+            }
+            sample_rgb(bottom, job->is_gray, &r, &g, &b);
+            if (job->use_retro_colors) {
+                grid->bg_r[idx] = retro_channel(r); grid->bg_g[idx] = retro_channel(g); grid->bg_b[idx] = retro_channel(b);
+            } else {
+                grid->bg_r[idx] = (uint8_t)(r * 255); grid->bg_g[idx] = (uint8_t)(g * 255); grid->bg_b[idx] = (uint8_t)(b * 255);
+            }
+
+            grid->glyphs[idx] = UPPER_HALF_BLOCK;
+            grid->chars[idx] = get_ascii_char((sample_grayscale(top, job->is_gray) + sample_grayscale(bottom, job->is_gray)) / 2.0);
+        }
+    }
+}
+
+// Braille dot bit for sample (dx, dy) of a 2x4 cell
+static const uint8_t braille_bits[4][2] = {
+    {0x01, 0x08},
+    {0x02, 0x10},
+    {0x04, 0x20},
+    {0x40, 0x80},
+};
+
+// Ordered-dither thresholds, so the share of raised dots follows the brightness
+static const double braille_thresholds[4][2] = {
+    {0.5 / 8, 4.5 / 8},
+    {6.5 / 8, 2.5 / 8},
+    {1.5 / 8, 5.5 / 8},
+    {7.5 / 8, 3.5 / 8},
+};
+
+// Braille: brightness becomes dot density, the color is the hue of the raised dots
+// (full value, as for ASCII characters)
+HOT_KERNEL
+static void fill_braille(void* arg, size_t row_begin, size_t row_end) {
+    glyph_job_t* job = arg;
+    ascii_grid_t* grid = job->grid;
+    image_t* resized = job->resized;
 
+    for (size_t y = row_begin; y < row_end; y++) {
+        for (size_t x = 0; x < grid->width; x++) {
+            size_t idx = y * grid->width + x;
+            if (job->mask && !job->mask[idx]) continue;
+            uint8_t bits = 0;
+            double sum_gray = 0.0;
+            double lit[3] = {0.0, 0.0, 0.0}, all[3] = {0.0, 0.0, 0.0};
+            int n_lit = 0;
+
+            for (size_t dy = 0; dy < 4; dy++) {
+                for (size_t dx = 0; dx < 2; dx++) {
+                    const double* pixel = get_sample(resized, 2 * x + dx, 4 * y + dy);
+                    double gray = sample_grayscale(pixel, job->is_gray);
+                    double rgb[3];
+                    sample_rgb(pixel, job->is_gray, &rgb[0], &rgb[1], &rgb[2]);
+                    for (int c = 0; c < 3; c++) all[c] += rgb[c];
+                    sum_gray += gray;
+
+                    if (gray > braille_thresholds[dy][dx]) {
+                        bits |= braille_bits[dy][dx];
+                        for (int c = 0; c < 3; c++) lit[c] += rgb[c];
+                        n_lit++;
+                    }
+                }
+            }
+
+            // Color of the raised dots (of the whole cell if none is raised)
+            double r, g, b;
+            if (n_lit > 0) {
+                r = lit[0] / n_lit; g = lit[1] / n_lit; b = lit[2] / n_lit;
+            } else {
+                r = all[0] / 8; g = all[1] / 8; b = all[2] / 8;
+            }
+            if (!job->is_gray) {
+                hsv_t hsv = rgb_to_hsv(r, g, b);
+                if (job->use_retro_colors) get_retro_rgb(&hsv, &r, &g, &b);
+                else { hsv.value = 1.0; hsv_to_rgb(&hsv, &r, &g, &b); }
+            }
+
+            grid->r[idx] = (uint8_t)(r * 255); grid->g[idx] = (uint8_t)(g * 255); grid->b[idx] = (uint8_t)(b * 255);
+            grid->glyphs[idx] = BRAILLE_BASE + bits;
+            grid->chars[idx] = get_ascii_char(sum_gray / 8);
+        }
+    }
+}
+
+// --- Grid Geometry ---
+
+// Part of `original` to convert: options->crop clamped to the image, or all of it
+static image_region_t source_region(const image_t* original, const export_options_t* options) {
+    image_region_t region = options->crop;
+    if (region.width == 0 || region.height == 0 || region.x >= original->width || region.y >= original->height) {
+        return (image_region_t) {0, 0, original->width, original->height};
+    }
+    if (region.width > original->width - region.x) region.width = original->width - region.x;
+    if (region.height > original->height - region.y) region.height = original->height - region.y;
+    return region;
+}
+
+// Grid size (before resizing) and character aspect ratio for the sizing mode in `options`.
+// Also sets options->cell_pixel_width/height.
+static void grid_geometry(const image_region_t* original, export_options_t* options,
+                          size_t* cols, size_t* rows, double* ratio) {
     // Init calculated cell pixel dimensions
     options->cell_pixel_width = 0;
     options->cell_pixel_height = 0;
@@ -124,50 +363,322 @@ ascii_grid_t process_image_to_grid(image_t* original, export_options_t* options)
     
     if (target_rows < 1) target_rows = 1;
 
-    // 2. Resize Image
-    image_t resized = make_resized(original, target_cols, target_rows, char_ratio);
-    
-    grid.width = resized.width;
-    grid.height = resized.height;
-    grid.cells = malloc(sizeof(ascii_cell_t) * grid.width * grid.height);
-
-    // 3. Edge Detection
-    image_t grayscale = make_grayscale(&resized);
-    double* sobel_x = calloc(grayscale.width * grayscale.height, sizeof(*sobel_x));
-    double* sobel_y = calloc(grayscale.width * grayscale.height, sizeof(*sobel_y));
-    double edge_threshold = DEFAULT_EDGE_THRESHOLD; 
-    get_sobel(&grayscale, sobel_x, sobel_y);
-
-    // 4. Fill Grid
-    for (size_t y = 0; y < grid.height; y++) {
-        for (size_t x = 0; x < grid.width; x++) {
-            size_t idx = y * grid.width + x;
-            ascii_cell_t* cell = &grid.cells[idx];
-            double* pixel = get_pixel(&resized, x, y);
-            
-            double r_d, g_d, b_d;
-            double val_grayscale;
-            
-            if (resized.channels <= 2) {
-                 val_grayscale = pixel[0];
-                 r_d = g_d = b_d = pixel[0];
-            } else {
-                hsv_t hsv = rgb_to_hsv(pixel[0], pixel[1], pixel[2]);
-                val_grayscale = calculate_grayscale_from_hsv(&hsv);
-                if (options->use_retro_colors) get_retro_rgb(&hsv, &r_d, &g_d, &b_d);
-                else { hsv.value = 1.0; hsv_to_rgb(&hsv, &r_d, &g_d, &b_d); }
+    *cols = target_cols;
+    *rows = target_rows;
+    *ratio = char_ratio;
+}
+
+// --- Adaptive Palette ---
+
+// Snaps every cell (and background) color to the nearest of `n_colors` built from the grid
+static void snap_to_palette(ascii_grid_t* grid, size_t n_colors, arena_t* arena) {
+    size_t n_cells = grid->width * grid->height;
+    palette_t palette = {0};
+    if (palette_build(&palette, grid->r, grid->g, grid->b, n_cells, 1, n_colors, arena) == 0) {
+        for (size_t i = 0; i < n_cells; i++) {
+            const uint8_t* color = palette.colors[palette_lookup(&palette, grid->r[i], grid->g[i], grid->b[i])];
+            grid->r[i] = color[0]; grid->g[i] = color[1]; grid->b[i] = color[2];
+            if (grid->bg_r) {
+                color = palette.colors[palette_lookup(&palette, grid->bg_r[i], grid->bg_g[i], grid->bg_b[i])];
+                grid->bg_r[i] = color[0]; grid->bg_g[i] = color[1]; grid->bg_b[i] = color[2];
             }
-            
-            cell->r = (uint8_t)(r_d * 255); cell->g = (uint8_t)(g_d * 255); cell->b = (uint8_t)(b_d * 255);
-            cell->character = get_ascii_char(val_grayscale);
+        }
+    }
+    if (!arena) free_palette(&palette);
+}
 
-            size_t sobel_idx = y * grayscale.width + x; 
-            if ((sobel_x[sobel_idx]*sobel_x[sobel_idx] + sobel_y[sobel_idx]*sobel_y[sobel_idx]) >= edge_threshold * edge_threshold) {
-                cell->character = get_sobel_angle_char(atan2(sobel_y[sobel_idx], sobel_x[sobel_idx]) * 180. / M_PI);
+// --- Main Processing Function ---
+
+ascii_grid_t process_image_to_grid(image_t* original, export_options_t* options, arena_t* arena) {
+    ascii_grid_t grid = {0};
+    if (!original || !original->data) return grid;
+
+    size_t target_cols, target_rows;
+    double char_ratio;
+    image_region_t region = source_region(original, options);
+    grid_geometry(&region, options, &target_cols, &target_rows, &char_ratio);
+
+    // 2. Resize Image (several samples per cell in the high-density modes); only
+    // the region is read, and every later stage works on the resized pixels
+    glyph_mode_t glyph_mode = options->glyph_mode;
+    size_t samples_x = (glyph_mode == GLYPH_MODE_BRAILLE) ? 2 : 1;
+    size_t samples_y = (glyph_mode == GLYPH_MODE_BRAILLE) ? 4 : (glyph_mode == GLYPH_MODE_HALF) ? 2 : 1;
+    image_t resized = make_resized_region(original, &region, target_cols * samples_x, target_rows * samples_y,
+                                          char_ratio * samples_x / samples_y, arena);
+
+    size_t grid_w = (resized.width + samples_x - 1) / samples_x;
+    size_t grid_h = (resized.height + samples_y - 1) / samples_y;
+    size_t n_cells = grid_w * grid_h;
+    alloc_ascii_grid(&grid, grid_w, grid_h, arena);
+    if (grid.chars && glyph_mode != GLYPH_MODE_ASCII &&
+        alloc_grid_glyphs(&grid, glyph_mode == GLYPH_MODE_HALF, arena) != 0) {
+        if (!arena) free_ascii_grid(&grid);
+        grid = (ascii_grid_t) {0};
+    }
+
+    if (!resized.data || !resized.width || !resized.height || !grid.chars) {
+        fprintf(stderr, "Error: Failed to allocate memory for ASCII grid!\n");
+        if (!arena) {
+            free_ascii_grid(&grid); free_image(&resized);
+        }
+        return (ascii_grid_t) {0};
+    }
+
+    // 3. Edge Detection (skipped entirely when disabled, and in the high-density modes)
+    int use_edges = !options->disable_edges && glyph_mode == GLYPH_MODE_ASCII;
+    image_t grayscale = {0};
+    double* sobel_x = NULL;
+    double* sobel_y = NULL;
+    if (use_edges) {
+        grayscale = make_grayscale(&resized, arena);
+        sobel_x = arena ? arena_calloc(arena, n_cells, sizeof(*sobel_x)) : calloc(n_cells, sizeof(*sobel_x));
+        sobel_y = arena ? arena_calloc(arena, n_cells, sizeof(*sobel_y)) : calloc(n_cells, sizeof(*sobel_y));
+        if (!grayscale.data || !sobel_x || !sobel_y) {
+            fprintf(stderr, "Error: Failed to allocate memory for edge detection!\n");
+            if (!arena) {
+                free(sobel_x); free(sobel_y); free_ascii_grid(&grid); free_image(&grayscale); free_image(&resized);
             }
+            return (ascii_grid_t) {0};
         }
+        get_sobel(&grayscale, sobel_x, sobel_y);
     }
 
-    free(sobel_x); free(sobel_y); free_image(&grayscale); free_image(&resized);
+    // 4. Fill Grid (row bands on the thread pool), with the variant for this conversion's modes
+    int is_gray = resized.channels <= 2;
+    int use_retro_colors = options->use_retro_colors != 0;
+    if (glyph_mode == GLYPH_MODE_ASCII) {
+        fill_job_t fill = {&grid, &resized, sobel_x, sobel_y, DEFAULT_EDGE_THRESHOLD, NULL};
+        parallel_for(grid.height, ROWS_PER_TASK, fill_variants[is_gray][use_retro_colors][use_edges], &fill);
+    } else {
+        glyph_job_t fill = {&grid, &resized, is_gray, use_retro_colors, NULL};
+        parallel_for(grid.height, ROWS_PER_TASK, glyph_mode == GLYPH_MODE_HALF ? fill_half : fill_braille, &fill);
+    }
+
+    // 5. Adaptive Palette: snap every cell to the nearest of N colors built from this image
+    if (options->palette_size > 0) snap_to_palette(&grid, (size_t) options->palette_size, arena);
+
+    if (!arena) {
+        free(sobel_x); free(sobel_y); free_image(&grayscale); free_image(&resized);
+    }
     return grid;
-}
\ No newline at end of file
+}
+
+// --- Incremental Conversion ---
+
+// Frees the previous frame's stages; the statistics are kept
+static void history_reset(frame_history_t* history) {
+    size_t recomputed = history->cells_recomputed, total = history->cells_total;
+    free_image(&history->resized);
+    free_image(&history->grayscale);
+    free(history->sobel_x);
+    free(history->sobel_y);
+    free_ascii_grid(&history->grid);
+    free(history->pixel_mask);
+    free(history->cell_mask);
+    *history = (frame_history_t) {0};
+    history->cells_recomputed = recomputed;
+    history->cells_total = total;
+}
+
+void frame_history_free(frame_history_t* history) {
+    if (history) history_reset(history);
+}
+
+// Whether the state was built for a source of this size and these processing options
+static int same_key(const frame_history_t* history, const image_t* original, const export_options_t* options) {
+    const export_options_t* key = &history->key;
+    return history->valid &&
+           history->src_width == original->width && history->src_height == original->height &&
+           history->src_channels == original->channels &&
+           key->glyph_mode == options->glyph_mode && key->use_retro_colors == options->use_retro_colors &&
+           key->palette_size == options->palette_size && key->disable_edges == options->disable_edges &&
+           key->width_chars == options->width_chars && key->scale_factor == options->scale_factor &&
+           key->target_pixel_w == options->target_pixel_w && key->target_pixel_h == options->target_pixel_h &&
+           key->crop.x == options->crop.x && key->crop.y == options->crop.y &&
+           key->crop.width == options->crop.width && key->crop.height == options->crop.height;
+}
+
+// Resizes the whole frame and allocates every stage for this size
+static int history_init(frame_history_t* history, image_t* original, const image_region_t* region,
+                        export_options_t* options, size_t target_cols, size_t target_rows, double char_ratio,
+                        size_t samples_x, size_t samples_y, int use_edges) {
+    history->resized = make_resized_region(original, region, target_cols * samples_x, target_rows * samples_y,
+                                           char_ratio * samples_x / samples_y, NULL);
+    image_t* resized = &history->resized;
+    if (!resized->data || !resized->width || !resized->height) return -1;
+
+    size_t n_pixels = resized->width * resized->height;
+    size_t grid_w = (resized->width + samples_x - 1) / samples_x;
+    size_t grid_h = (resized->height + samples_y - 1) / samples_y;
+    if (alloc_ascii_grid(&history->grid, grid_w, grid_h, NULL) != 0 ||
+        (options->glyph_mode != GLYPH_MODE_ASCII &&
+         alloc_grid_glyphs(&history->grid, options->glyph_mode == GLYPH_MODE_HALF, NULL) != 0)) {
+        fprintf(stderr, "Error: Failed to allocate memory for ASCII grid!\n");
+        return -1;
+    }
+
+    // Cells never outnumber resized pixels
+    history->pixel_mask = malloc(n_pixels);
+    history->cell_mask = malloc(n_pixels);
+    if (use_edges) {
+        history->grayscale = (image_t) {resized->width, resized->height, 1, calloc(n_pixels, sizeof(double))};
+        history->sobel_x = calloc(n_pixels, sizeof(double));
+        history->sobel_y = calloc(n_pixels, sizeof(double));
+    }
+    if (!history->pixel_mask || !history->cell_mask ||
+        (use_edges && (!history->grayscale.data || !history->sobel_x || !history->sobel_y))) {
+        fprintf(stderr, "Error: Failed to allocate memory for incremental conversion!\n");
+        return -1;
+    }
+
+    history->src_width = original->width;
+    history->src_height = original->height;
+    history->src_channels = original->channels;
+    history->key = *options;
+    history->valid = 1;
+    return 0;
+}
+
+// Flags the resized pixels whose source block touches a dirty tile; returns their number
+static size_t mark_dirty_pixels(const image_t* original, const image_region_t* region, const image_t* resized,
+                                const uint8_t* dirty_tiles, uint8_t* mask) {
+    size_t tiles_x = (original->width + DIRTY_TILE_SIZE - 1) / DIRTY_TILE_SIZE;
+    size_t n_dirty = 0;
+
+    for (size_t j = 0; j < resized->height; j++) {
+        // Same blocks as make_resized_region
+        size_t y1 = region->y + (j * region->height) / resized->height;
+        size_t y2 = region->y + ((j + 1) * region->height) / resized->height;
+        if (y2 <= y1) y2 = y1 + 1;
+        for (size_t i = 0; i < resized->width; i++) {
+            size_t x1 = region->x + (i * region->width) / resized->width;
+            size_t x2 = region->x + ((i + 1) * region->width) / resized->width;
+            if (x2 <= x1) x2 = x1 + 1;
+
+            uint8_t dirty = 0;
+            for (size_t ty = y1 / DIRTY_TILE_SIZE; ty <= (y2 - 1) / DIRTY_TILE_SIZE && !dirty; ty++) {
+                for (size_t tx = x1 / DIRTY_TILE_SIZE; tx <= (x2 - 1) / DIRTY_TILE_SIZE; tx++) {
+                    dirty |= dirty_tiles[ty * tiles_x + tx];
+                }
+            }
+            mask[j * resized->width + i] = dirty != 0;
+            n_dirty += dirty != 0;
+        }
+    }
+    return n_dirty;
+}
+
+// out = in grown by one pixel in every direction (the reach of the 3x3 Sobel kernels)
+static void dilate_mask(const uint8_t* in, uint8_t* out, size_t width, size_t height) {
+    for (size_t y = 0; y < height; y++) {
+        size_t y1 = y > 0 ? y - 1 : 0, y2 = y + 1 < height ? y + 1 : y;
+        for (size_t x = 0; x < width; x++) {
+            size_t x1 = x > 0 ? x - 1 : 0, x2 = x + 1 < width ? x + 1 : x;
+            uint8_t dirty = 0;
+            for (size_t ny = y1; ny <= y2; ny++) {
+                for (size_t nx = x1; nx <= x2; nx++) dirty |= in[ny * width + nx];
+            }
+            out[y * width + x] = dirty;
+        }
+    }
+}
+
+// High-density modes: a cell is dirty if any of its samples is (same clamping as get_sample)
+static void mark_dirty_cells(const uint8_t* pixel_mask, const image_t* resized, const ascii_grid_t* grid,
+                             size_t samples_x, size_t samples_y, uint8_t* cell_mask) {
+    for (size_t y = 0; y < grid->height; y++) {
+        for (size_t x = 0; x < grid->width; x++) {
+            uint8_t dirty = 0;
+            for (size_t dy = 0; dy < samples_y; dy++) {
+                size_t py = y * samples_y + dy;
+                if (py >= resized->height) py = resized->height - 1;
+                for (size_t dx = 0; dx < samples_x; dx++) {
+                    size_t px = x * samples_x + dx;
+                    if (px >= resized->width) px = resized->width - 1;
+                    dirty |= pixel_mask[py * resized->width + px];
+                }
+            }
+            cell_mask[y * grid->width + x] = dirty;
+        }
+    }
+}
+
+ascii_grid_t process_image_incremental(image_t* original, const uint8_t* dirty_tiles,
+                                       export_options_t* options, frame_history_t* history) {
+    if (!original || !original->data || !history) return (ascii_grid_t) {0};
+
+    size_t target_cols, target_rows;
+    double char_ratio;
+    image_region_t region = source_region(original, options);
+    grid_geometry(&region, options, &target_cols, &target_rows, &char_ratio);
+
+    glyph_mode_t glyph_mode = options->glyph_mode;
+    size_t samples_x = (glyph_mode == GLYPH_MODE_BRAILLE) ? 2 : 1;
+    size_t samples_y = (glyph_mode == GLYPH_MODE_BRAILLE) ? 4 : (glyph_mode == GLYPH_MODE_HALF) ? 2 : 1;
+    int use_edges = !options->disable_edges && glyph_mode == GLYPH_MODE_ASCII;
+
+    // 1. New size or options: start over from a full resize
+    int fresh = 0;
+    if (!same_key(history, original, options)) {
+        history_reset(history);
+        if (history_init(history, original, &region, options, target_cols, target_rows, char_ratio,
+                         samples_x, samples_y, use_edges) != 0) {
+            history_reset(history);
+            return (ascii_grid_t) {0};
+        }
+        fresh = 1;
+    }
+
+    image_t* resized = &history->resized;
+    ascii_grid_t* grid = &history->grid;
+    size_t n_pixels = resized->width * resized->height;
+    size_t n_cells = grid->width * grid->height;
+    history->cells_total += n_cells;
+
+    // 2. Resized pixels whose source block changed. The adaptive palette depends
+    // on every cell, so it needs the whole frame.
+    int full = fresh || !dirty_tiles || options->palette_size > 0;
+    uint8_t* pixel_mask = history->pixel_mask;
+    if (full) {
+        memset(pixel_mask, 1, n_pixels);
+    } else {
+        if (mark_dirty_pixels(original, &region, resized, dirty_tiles, pixel_mask) == 0) return *grid;
+    }
+    if (!fresh) update_resized(original, &region, resized, pixel_mask);
+
+    // 3. Edges: grayscale of the changed pixels, Sobel of them and of their neighbours
+    const uint8_t* cell_mask = pixel_mask;
+    if (use_edges) {
+        update_grayscale(resized, &history->grayscale, pixel_mask);
+        dilate_mask(pixel_mask, history->cell_mask, resized->width, resized->height);
+        update_sobel(&history->grayscale, history->sobel_x, history->sobel_y, history->cell_mask);
+        cell_mask = history->cell_mask;
+    } else if (glyph_mode != GLYPH_MODE_ASCII) {
+        mark_dirty_cells(pixel_mask, resized, grid, samples_x, samples_y, history->cell_mask);
+        cell_mask = history->cell_mask;
+    }
+
+    // 4. Fill the dirty cells
+    size_t n_recomputed = n_cells;
+    if (!full) {
+        n_recomputed = 0;
+        for (size_t i = 0; i < n_cells; i++) n_recomputed += cell_mask[i] != 0;
+    }
+    history->cells_recomputed += n_recomputed;
+
+    int is_gray = resized->channels <= 2;
+    int use_retro_colors = options->use_retro_colors != 0;
+    const uint8_t* fill_mask = full ? NULL : cell_mask;
+    if (glyph_mode == GLYPH_MODE_ASCII) {
+        fill_job_t fill = {grid, resized, history->sobel_x, history->sobel_y, DEFAULT_EDGE_THRESHOLD, fill_mask};
+        parallel_for(grid->height, ROWS_PER_TASK, fill_variants[is_gray][use_retro_colors][use_edges], &fill);
+    } else {
+        glyph_job_t fill = {grid, resized, is_gray, use_retro_colors, fill_mask};
+        parallel_for(grid->height, ROWS_PER_TASK, glyph_mode == GLYPH_MODE_HALF ? fill_half : fill_braille, &fill);
+    }
+
+    // 5. Adaptive Palette
+    if (options->palette_size > 0) snap_to_palette(grid, (size_t) options->palette_size, NULL);
+
+    return *grid;
+}
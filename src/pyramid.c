@@ -0,0 +1,89 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../include/pyramid.h"
+
+static void* build_levels(void* data) {
+    mip_pyramid_t* pyramid = data;
+    for (size_t l = 1; l < pyramid->n_levels; l++) {
+        if (__atomic_load_n(&pyramid->cancel, __ATOMIC_ACQUIRE)) break;
+        image_t* finer = &pyramid->levels[l - 1];
+        image_t level = make_downsampled(finer, (finer->width + 1) / 2, (finer->height + 1) / 2, NULL);
+        if (!level.data) break; // Error printed inside make_downsampled
+        pyramid->levels[l] = level;
+
+        pthread_mutex_lock(&pyramid->mutex);
+        __atomic_store_n(&pyramid->n_ready, l + 1, __ATOMIC_RELEASE);
+        pthread_cond_broadcast(&pyramid->progress);
+        pthread_mutex_unlock(&pyramid->mutex);
+    }
+
+    pthread_mutex_lock(&pyramid->mutex);
+    pyramid->finished = 1;
+    pthread_cond_broadcast(&pyramid->progress);
+    pthread_mutex_unlock(&pyramid->mutex);
+    return NULL;
+}
+
+int pyramid_start(mip_pyramid_t* pyramid, image_t* original) {
+    *pyramid = (mip_pyramid_t) {0};
+
+    size_t n_levels = 1;
+    for (size_t w = original->width, h = original->height; w > PYRAMID_MIN_SIDE || h > PYRAMID_MIN_SIDE; n_levels++) {
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+    }
+    pyramid->levels = calloc(n_levels, sizeof(*pyramid->levels));
+    if (!pyramid->levels) {
+        fprintf(stderr, "Error: Failed to allocate memory for image pyramid!\n");
+        return -1;
+    }
+    pyramid->levels[0] = *original;
+    pyramid->n_levels = n_levels;
+    pyramid->n_ready = 1;
+    pthread_mutex_init(&pyramid->mutex, NULL);
+    pthread_cond_init(&pyramid->progress, NULL);
+    if (n_levels == 1) {
+        pyramid->finished = 1;
+        return 0;
+    }
+
+    if (pthread_create(&pyramid->thread, NULL, build_levels, pyramid) != 0) {
+        fprintf(stderr, "Error: Failed to start the image pyramid thread!\n");
+        pyramid->n_levels = 1;
+        pyramid->finished = 1;
+        return -1;
+    }
+    pyramid->running = 1;
+    return 0;
+}
+
+image_t* pyramid_level(mip_pyramid_t* pyramid, size_t max_level, size_t* level) {
+    size_t n_ready = __atomic_load_n(&pyramid->n_ready, __ATOMIC_ACQUIRE);
+    size_t l = max_level < n_ready ? max_level : n_ready - 1;
+    if (level) *level = l;
+    return &pyramid->levels[l];
+}
+
+void pyramid_wait(mip_pyramid_t* pyramid, size_t level) {
+    pthread_mutex_lock(&pyramid->mutex);
+    while (!pyramid->finished && __atomic_load_n(&pyramid->n_ready, __ATOMIC_ACQUIRE) <= level) {
+        pthread_cond_wait(&pyramid->progress, &pyramid->mutex);
+    }
+    pthread_mutex_unlock(&pyramid->mutex);
+}
+
+void pyramid_free(mip_pyramid_t* pyramid) {
+    if (!pyramid->levels) return;
+    if (pyramid->running) {
+        __atomic_store_n(&pyramid->cancel, 1, __ATOMIC_RELEASE);
+        pthread_join(pyramid->thread, NULL);
+    }
+    size_t n_ready = __atomic_load_n(&pyramid->n_ready, __ATOMIC_ACQUIRE);
+    for (size_t l = 1; l < n_ready; l++) free_image(&pyramid->levels[l]);
+    free(pyramid->levels);
+    pthread_mutex_destroy(&pyramid->mutex);
+    pthread_cond_destroy(&pyramid->progress);
+    *pyramid = (mip_pyramid_t) {0};
+}
@@ -0,0 +1,188 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../include/sixel.h"
+#include "../include/palette.h"
+#include "../include/threadpool.h"
+#include "../include/cpu_dispatch.h"
+
+#define SIXEL_BEGIN "\x1bPq"
+#define SIXEL_END "\x1b\\"
+#define BAND_HEIGHT 6
+#define MIN_RUN 4                       // Shorter runs are cheaper written out than as "!n"
+#define FLUSH_BYTES (64 * 1024)         // Hand bands to the terminal once this much is queued
+#define ROWS_PER_TASK 8
+
+// --- Quantization ---
+
+typedef struct {
+    const image_t* resized;
+    uint8_t *r, *g, *b;
+    const palette_t* palette;
+    uint8_t* indices;
+} quantize_job_t;
+
+static void to_rgb8_rows(void* arg, size_t row_begin, size_t row_end) {
+    quantize_job_t* job = arg;
+    const image_t* resized = job->resized;
+    size_t channels = resized->channels;
+
+    for (size_t i = row_begin * resized->width; i < row_end * resized->width; i++) {
+        const double* pixel = &resized->data[i * channels];
+        if (channels < 3) {
+            job->r[i] = job->g[i] = job->b[i] = (uint8_t) (pixel[0] * 255);
+        } else {
+            job->r[i] = (uint8_t) (pixel[0] * 255);
+            job->g[i] = (uint8_t) (pixel[1] * 255);
+            job->b[i] = (uint8_t) (pixel[2] * 255);
+        }
+    }
+}
+
+// Straight table lookups over the planes: no per-pixel distance search
+HOT_KERNEL
+static void quantize_rows(void* arg, size_t row_begin, size_t row_end) {
+    quantize_job_t* job = arg;
+    const uint8_t* lut = job->palette->lut;
+    size_t width = job->resized->width;
+
+    for (size_t i = row_begin * width; i < row_end * width; i++) {
+        job->indices[i] = lut[COLOR_LUT_KEY(job->r[i], job->g[i], job->b[i])];
+    }
+}
+
+// --- Encoder ---
+
+static void put_run(term_writer_t* out, char c, size_t n) {
+    if (n >= MIN_RUN) {
+        term_put_char(out, '!');
+        term_put_uint(out, n);
+        term_put_char(out, c);
+    } else {
+        while (n-- > 0) term_put_char(out, c);
+    }
+}
+
+// Encodes pixel rows [y0, y0 + BAND_HEIGHT) as one sixel band: one pass per color
+// present in the band, each limited to the columns up to its last pixel
+static int encode_band(term_writer_t* out, const uint8_t* indices, size_t width, size_t height,
+                       size_t y0, size_t n_colors) {
+    size_t rows = (y0 + BAND_HEIGHT <= height) ? BAND_HEIGHT : height - y0;
+    size_t last_x[PALETTE_MAX_COLORS];
+    uint8_t present[PALETTE_MAX_COLORS] = {0};
+    size_t n_present = 0;
+
+    for (size_t r = 0; r < rows; r++) {
+        const uint8_t* row = &indices[(y0 + r) * width];
+        for (size_t x = 0; x < width; x++) {
+            uint8_t c = row[x];
+            if (!present[c]) {
+                present[c] = 1;
+                last_x[c] = x;
+                n_present++;
+            } else if (x > last_x[c]) {
+                last_x[c] = x;
+            }
+        }
+    }
+
+    // "#nnn" + one character per column + "$" per color, "-" per band
+    if (term_writer_reserve(out, n_present * (width + 6) + 1) != 0) return -1;
+
+    size_t done = 0;
+    for (size_t c = 0; c < n_colors; c++) {
+        if (!present[c]) continue;
+
+        term_put_char(out, '#');
+        term_put_uint(out, c);
+
+        char run_char = 0;
+        size_t run_length = 0;
+        for (size_t x = 0; x <= last_x[c]; x++) {
+            unsigned bits = 0;
+            for (size_t r = 0; r < rows; r++) {
+                bits |= (unsigned) (indices[(y0 + r) * width + x] == c) << r;
+            }
+            char sixel = (char) ('?' + bits);
+            if (sixel == run_char) {
+                run_length++;
+            } else {
+                put_run(out, run_char, run_length);
+                run_char = sixel;
+                run_length = 1;
+            }
+        }
+        put_run(out, run_char, run_length);
+
+        // Back to the start of the band for the next color
+        if (++done < n_present) term_put_char(out, '$');
+    }
+    term_put_char(out, '-');
+    return 0;
+}
+
+int sixel_write(image_t* original, size_t max_width, size_t max_height, size_t max_colors,
+                term_writer_t* out, arena_t* arena) {
+    if (!original || !original->data || !out) return -1;
+
+    // Averaging only shrinks: never ask for more pixels than the source has
+    if (max_width > original->width) max_width = original->width;
+    if (max_height > original->height) max_height = original->height;
+    if (max_width < 1 || max_height < 1) return -1;
+
+    image_t resized = make_resized(original, max_width, max_height, 1.0, arena);
+    size_t n_pixels = resized.width * resized.height;
+    uint8_t* planes = NULL;
+    int status = -1;
+    palette_t palette = {0};
+
+    if (!resized.data || n_pixels == 0) goto done;
+    planes = arena ? arena_alloc(arena, 4 * n_pixels) : malloc(4 * n_pixels);
+    if (!planes) {
+        fprintf(stderr, "Error: Failed to allocate memory for sixel image!\n");
+        goto done;
+    }
+
+    // 1. 8-bit planes, adaptive palette, table quantization
+    quantize_job_t job = {&resized, planes, planes + n_pixels, planes + 2 * n_pixels, &palette, planes + 3 * n_pixels};
+    parallel_for(resized.height, ROWS_PER_TASK, to_rgb8_rows, &job);
+    if (palette_build(&palette, job.r, job.g, job.b, n_pixels, 1, max_colors, arena) != 0 || palette.n_colors == 0) {
+        goto done;
+    }
+    parallel_for(resized.height, ROWS_PER_TASK, quantize_rows, &job);
+
+    // 2. Header: raster attributes (1:1 pixels) and color registers (RGB in percent)
+    if (term_writer_reserve(out, 64 + palette.n_colors * 24) != 0) goto done;
+    term_put_literal(out, SIXEL_BEGIN "\"1;1;");
+    term_put_uint(out, resized.width);
+    term_put_char(out, ';');
+    term_put_uint(out, resized.height);
+    for (size_t c = 0; c < palette.n_colors; c++) {
+        term_put_char(out, '#');
+        term_put_uint(out, c);
+        term_put_literal(out, ";2;");
+        for (int k = 0; k < 3; k++) {
+            if (k > 0) term_put_char(out, ';');
+            term_put_u8(out, (uint8_t) ((palette.colors[c][k] * 100 + 127) / 255));
+        }
+    }
+
+    // 3. Bands, streamed to the terminal as the buffer fills up
+    for (size_t y0 = 0; y0 < resized.height; y0 += BAND_HEIGHT) {
+        if (encode_band(out, job.indices, resized.width, resized.height, y0, palette.n_colors) != 0) goto done;
+        if (out->length >= FLUSH_BYTES && term_writer_flush(out) != 0) goto done;
+    }
+
+    if (term_writer_reserve(out, sizeof(SIXEL_END) + 1) != 0) goto done;
+    term_put_literal(out, SIXEL_END "\n");
+    status = 0;
+
+done:
+    if (!arena) {
+        free(planes);
+        free_palette(&palette);
+        free_image(&resized);
+    }
+    return status;
+}
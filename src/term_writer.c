@@ -0,0 +1,81 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../include/term_writer.h"
+
+#define INITIAL_CAPACITY (64 * 1024)
+
+char term_decimal[256][4];
+uint8_t term_decimal_length[256];
+static pthread_once_t decimal_once = PTHREAD_ONCE_INIT;
+
+static void build_decimal_table(void) {
+    for (int v = 0; v < 256; v++) {
+        term_decimal_length[v] = (uint8_t) snprintf(term_decimal[v], sizeof(term_decimal[v]), "%d", v);
+    }
+}
+
+void term_writer_init(term_writer_t* writer, int fd) {
+    pthread_once(&decimal_once, build_decimal_table);
+    writer->data = NULL;
+    writer->length = 0;
+    writer->capacity = 0;
+    writer->fd = fd;
+    writer->bytes_written = 0;
+    writer->write_seconds = 0.0;
+}
+
+void term_writer_free(term_writer_t* writer) {
+    free(writer->data);
+    writer->data = NULL;
+    writer->length = writer->capacity = 0;
+}
+
+int term_writer_reserve(term_writer_t* writer, size_t extra) {
+    // term_put_u8 copies 4 bytes at a time: keep slack at the end
+    size_t needed = writer->length + extra + 4;
+    if (needed <= writer->capacity) return 0;
+
+    size_t capacity = writer->capacity ? writer->capacity : INITIAL_CAPACITY;
+    while (capacity < needed) capacity *= 2;
+
+    char* data = realloc(writer->data, capacity);
+    if (!data) {
+        fprintf(stderr, "Error: Failed to allocate memory for output buffer!\n");
+        return -1;
+    }
+    writer->data = data;
+    writer->capacity = capacity;
+    return 0;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int term_writer_flush(term_writer_t* writer) {
+    if (writer->length == 0) return 0;
+
+    // Blocking time is what a slow terminal or link costs: keep track of it
+    double start = now_seconds();
+    size_t offset = 0;
+    while (offset < writer->length) {
+        ssize_t n = write(writer->fd, writer->data + offset, writer->length - offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            writer->length = 0;
+            return -1;
+        }
+        offset += (size_t) n;
+    }
+    writer->bytes_written += offset;
+    writer->write_seconds += now_seconds() - start;
+    writer->length = 0;
+    return 0;
+}
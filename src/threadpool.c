@@ -0,0 +1,246 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "../include/threadpool.h"
+
+#define MAX_THREADS 64
+#define INITIAL_DEQUE_CAPACITY 64
+
+typedef struct {
+    size_t remaining;       // Tasks not yet completed (protected by mutex)
+    pthread_mutex_t mutex;
+    pthread_cond_t done;
+} job_t;
+
+typedef struct {
+    task_fn fn;
+    void* arg;
+    size_t begin, end;
+    job_t* job;
+} task_t;
+
+// Ring buffer: the owner pushes/pops at the bottom, thieves take from the top
+typedef struct {
+    pthread_mutex_t mutex;
+    task_t* tasks;
+    size_t capacity;
+    size_t top;             // Index of the oldest task
+    size_t count;
+} deque_t;
+
+typedef struct {
+    size_t n_threads;       // Workers + caller
+    size_t n_workers;
+    deque_t* deques;        // One per worker
+    pthread_t* threads;
+
+    pthread_mutex_t mutex;  // Protects sleeping workers
+    pthread_cond_t wake;
+    size_t n_queued;        // Tasks waiting in any deque (atomic)
+    size_t next_deque;      // Round-robin cursor for submissions (atomic)
+} threadpool_t;
+
+static threadpool_t pool;
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+static int requested_threads = 0;
+static __thread long worker_index = -1; // Deque owned by the current thread, -1 if none
+
+// --- Deque ---
+
+static int deque_push(deque_t* deque, const task_t* task) {
+    pthread_mutex_lock(&deque->mutex);
+    if (deque->count == deque->capacity) {
+        size_t capacity = deque->capacity ? deque->capacity * 2 : INITIAL_DEQUE_CAPACITY;
+        task_t* tasks = malloc(capacity * sizeof(*tasks));
+        if (!tasks) {
+            pthread_mutex_unlock(&deque->mutex);
+            return -1;
+        }
+        for (size_t i = 0; i < deque->count; i++) {
+            tasks[i] = deque->tasks[(deque->top + i) % deque->capacity];
+        }
+        free(deque->tasks);
+        deque->tasks = tasks;
+        deque->capacity = capacity;
+        deque->top = 0;
+    }
+    deque->tasks[(deque->top + deque->count) % deque->capacity] = *task;
+    deque->count++;
+    pthread_mutex_unlock(&deque->mutex);
+    return 0;
+}
+
+static int deque_pop_bottom(deque_t* deque, task_t* task) {
+    int found = 0;
+    pthread_mutex_lock(&deque->mutex);
+    if (deque->count > 0) {
+        deque->count--;
+        *task = deque->tasks[(deque->top + deque->count) % deque->capacity];
+        found = 1;
+    }
+    pthread_mutex_unlock(&deque->mutex);
+    return found;
+}
+
+static int deque_steal_top(deque_t* deque, task_t* task) {
+    int found = 0;
+    pthread_mutex_lock(&deque->mutex);
+    if (deque->count > 0) {
+        *task = deque->tasks[deque->top];
+        deque->top = (deque->top + 1) % deque->capacity;
+        deque->count--;
+        found = 1;
+    }
+    pthread_mutex_unlock(&deque->mutex);
+    return found;
+}
+
+// --- Scheduling ---
+
+// Own deque first (newest task, warm cache), then steal the oldest task of the others
+static int find_task(task_t* task) {
+    if (__atomic_load_n(&pool.n_queued, __ATOMIC_ACQUIRE) == 0) return 0;
+
+    size_t start = (worker_index >= 0) ? (size_t) worker_index : 0;
+    if (worker_index >= 0 && deque_pop_bottom(&pool.deques[start], task)) goto found;
+
+    for (size_t i = 0; i < pool.n_workers; i++) {
+        size_t victim = (start + i + (worker_index >= 0)) % pool.n_workers;
+        if (deque_steal_top(&pool.deques[victim], task)) goto found;
+    }
+    return 0;
+
+found:
+    __atomic_sub_fetch(&pool.n_queued, 1, __ATOMIC_ACQ_REL);
+    return 1;
+}
+
+static void run_task(const task_t* task) {
+    task->fn(task->arg, task->begin, task->end);
+
+    // The count only changes under the lock: once the waiter sees zero
+    // nobody touches the job (which lives on the waiter's stack) again
+    job_t* job = task->job;
+    pthread_mutex_lock(&job->mutex);
+    if (--job->remaining == 0) pthread_cond_broadcast(&job->done);
+    pthread_mutex_unlock(&job->mutex);
+}
+
+static void* worker_main(void* data) {
+    worker_index = (long) (size_t) data;
+
+    for (;;) {
+        task_t task;
+        if (find_task(&task)) {
+            run_task(&task);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool.mutex);
+        while (__atomic_load_n(&pool.n_queued, __ATOMIC_ACQUIRE) == 0) {
+            pthread_cond_wait(&pool.wake, &pool.mutex);
+        }
+        pthread_mutex_unlock(&pool.mutex);
+    }
+    return NULL;
+}
+
+// --- Pool ---
+
+static void start_pool(void) {
+    size_t n_threads = (size_t) requested_threads;
+    if (n_threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        n_threads = (cpus > 0) ? (size_t) cpus : 1;
+    }
+    if (n_threads > MAX_THREADS) n_threads = MAX_THREADS;
+
+    pthread_mutex_init(&pool.mutex, NULL);
+    pthread_cond_init(&pool.wake, NULL);
+    pool.n_threads = 1;
+    pool.n_workers = 0;
+    if (n_threads < 2) return;
+
+    pool.deques = calloc(n_threads - 1, sizeof(*pool.deques));
+    pool.threads = calloc(n_threads - 1, sizeof(*pool.threads));
+    if (!pool.deques || !pool.threads) {
+        fprintf(stderr, "Warning: Failed to allocate thread pool, running single-threaded.\n");
+        return;
+    }
+
+    for (size_t i = 0; i < n_threads - 1; i++) {
+        pthread_mutex_init(&pool.deques[i].mutex, NULL);
+    }
+    // Workers are detached for the process lifetime
+    for (size_t i = 0; i < n_threads - 1; i++) {
+        if (pthread_create(&pool.threads[i], NULL, worker_main, (void*) i) != 0) break;
+        pthread_detach(pool.threads[i]);
+        pool.n_workers++;
+    }
+    pool.n_threads = pool.n_workers + 1;
+}
+
+void threadpool_set_threads(int n_threads) {
+    requested_threads = (n_threads > 0) ? n_threads : 0;
+}
+
+size_t threadpool_size(void) {
+    pthread_once(&pool_once, start_pool);
+    return pool.n_threads;
+}
+
+void parallel_for(size_t n_items, size_t grain, task_fn fn, void* arg) {
+    if (n_items == 0) return;
+    if (grain < 1) grain = 1;
+
+    pthread_once(&pool_once, start_pool);
+    if (pool.n_workers == 0 || n_items <= grain) {
+        fn(arg, 0, n_items);
+        return;
+    }
+
+    size_t n_tasks = (n_items + grain - 1) / grain;
+    job_t job = {.remaining = n_tasks};
+    pthread_mutex_init(&job.mutex, NULL);
+    pthread_cond_init(&job.done, NULL);
+
+    // Deal chunks round-robin over the deques; stealing evens out the rest.
+    // The queued count goes up before a task is published, so a thief taking it
+    // right away never drives the count below zero. Tasks that cannot be queued
+    // run inline.
+    size_t first = __atomic_fetch_add(&pool.next_deque, 1, __ATOMIC_RELAXED);
+    for (size_t t = 0; t < n_tasks; t++) {
+        task_t task = {fn, arg, t * grain, (t + 1) * grain < n_items ? (t + 1) * grain : n_items, &job};
+        __atomic_add_fetch(&pool.n_queued, 1, __ATOMIC_ACQ_REL);
+        if (deque_push(&pool.deques[(first + t) % pool.n_workers], &task) != 0) {
+            __atomic_sub_fetch(&pool.n_queued, 1, __ATOMIC_ACQ_REL);
+            run_task(&task);
+        }
+    }
+
+    pthread_mutex_lock(&pool.mutex);
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.mutex);
+
+    // Help until this job is complete
+    for (;;) {
+        task_t task;
+        if (find_task(&task)) {
+            run_task(&task);
+            continue;
+        }
+        pthread_mutex_lock(&job.mutex);
+        while (job.remaining > 0 && __atomic_load_n(&pool.n_queued, __ATOMIC_ACQUIRE) == 0) {
+            pthread_cond_wait(&job.done, &job.mutex);
+        }
+        size_t remaining = job.remaining;
+        pthread_mutex_unlock(&job.mutex);
+        if (remaining == 0) break;
+    }
+
+    pthread_mutex_destroy(&job.mutex);
+    pthread_cond_destroy(&job.done);
+}
@@ -0,0 +1,177 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "../include/transcode.h"
+#include "../include/asciivideo.h"
+#include "../include/process.h"
+#include "../include/threadpool.h"
+#include "../include/arena.h"
+
+#define FRAMES_PER_WORKER 2
+
+typedef struct {
+    ascii_grid_t grid;      // Converted frame waiting for its turn (heap, reused)
+    int ready;
+} slot_t;
+
+typedef struct {
+    video_stream_t* stream;
+    asciivideo_writer_t* writer;
+    const export_options_t* options;
+    size_t window;
+    slot_t* slots;          // Frame n waits in slots[n % window]
+
+    pthread_mutex_t mutex;
+    pthread_cond_t progress;
+    uint64_t next_read;     // Next frame to take from the stream
+    uint64_t next_write;    // Next frame to write to the file
+    int eof;
+    int failed;
+} transcode_job_t;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Called with the mutex held after a frame was stored: whoever completes the oldest
+// frame writes it, and every later frame that is already waiting
+static void write_ready_frames(transcode_job_t* job) {
+    while (!job->failed) {
+        slot_t* slot = &job->slots[job->next_write % job->window];
+        if (!slot->ready) break;
+        if (asciivideo_write_frame(job->writer, &slot->grid) != 0) {
+            fprintf(stderr, "Error: Failed to write the video file!\n");
+            job->failed = 1;
+        }
+        slot->ready = 0;
+        job->next_write++;
+    }
+}
+
+static void* worker_main(void* data) {
+    transcode_job_t* job = data;
+    video_stream_t* stream = job->stream;
+    size_t n_values = stream->width * stream->height * 3;
+
+    // Private buffers: the frame as read, as RGB24, as doubles, and the arena for the conversion
+    uint8_t* frame = malloc(stream->frame_bytes);
+    uint8_t* rgb = malloc(n_values);
+    image_t image = {stream->width, stream->height, 3, malloc(n_values * sizeof(double))};
+    arena_t arena;
+    arena_init(&arena, 0);
+
+    pthread_mutex_lock(&job->mutex);
+    if (!frame || !rgb || !image.data) {
+        fprintf(stderr, "Error: Failed to allocate memory for video frames!\n");
+        job->failed = 1;
+        pthread_cond_broadcast(&job->progress);
+    }
+    for (;;) {
+        while (!job->eof && !job->failed && job->next_read - job->next_write >= job->window) {
+            pthread_cond_wait(&job->progress, &job->mutex);
+        }
+        if (job->eof || job->failed) break;
+
+        // Reading is sequential: done under the lock, conversion is not
+        uint64_t index = job->next_read;
+        if (video_stream_read(stream, frame) != 0) {
+            job->eof = 1;
+            pthread_cond_broadcast(&job->progress);
+            break;
+        }
+        job->next_read++;
+        pthread_mutex_unlock(&job->mutex);
+
+        const uint8_t* pixels = video_stream_to_rgb(stream, frame, rgb);
+        for (size_t i = 0; i < n_values; i++) {
+            image.data[i] = pixels[i] / 255.0;
+        }
+        export_options_t options = *job->options;
+        arena_reset(&arena);
+        ascii_grid_t grid = process_image_to_grid(&image, &options, &arena);
+
+        pthread_mutex_lock(&job->mutex);
+        slot_t* slot = &job->slots[index % job->window];
+        if (!grid.chars || copy_ascii_grid(&slot->grid, &grid) != 0) {
+            fprintf(stderr, "Error: Failed to process video frame %llu.\n", (unsigned long long) index);
+            job->failed = 1;
+        }
+        slot->ready = 1;
+        write_ready_frames(job);
+        pthread_cond_broadcast(&job->progress);
+    }
+    pthread_mutex_unlock(&job->mutex);
+
+    arena_free(&arena);
+    free(image.data);
+    free(rgb);
+    free(frame);
+    return NULL;
+}
+
+int transcode_video(video_stream_t* stream, const char* output_path, const export_options_t* options,
+                    size_t window, uint32_t fps_num, uint32_t fps_den, transcode_stats_t* stats) {
+    double start = now_seconds();
+    size_t n_workers = threadpool_size();
+    if (window == 0) window = FRAMES_PER_WORKER * n_workers;
+    if (n_workers > window) n_workers = window; // More would only wait
+
+    transcode_job_t job = {0};
+    job.stream = stream;
+    job.options = options;
+    job.window = window;
+    job.slots = calloc(window, sizeof(*job.slots));
+    pthread_t* threads = calloc(n_workers, sizeof(*threads));
+    if (!job.slots || !threads) {
+        fprintf(stderr, "Error: Failed to allocate memory for transcoding!\n");
+        free(job.slots);
+        free(threads);
+        return -1;
+    }
+    job.writer = asciivideo_writer_open(output_path, fps_num, fps_den, 0);
+    if (!job.writer) {
+        free(job.slots);
+        free(threads);
+        return -1;
+    }
+    pthread_mutex_init(&job.mutex, NULL);
+    pthread_cond_init(&job.progress, NULL);
+
+    // Frame workers are plain threads: they block on the window, which pool tasks must
+    // not do. Each conversion still spreads its rows over the shared pool.
+    size_t n_started = 0;
+    for (; n_started < n_workers; n_started++) {
+        if (pthread_create(&threads[n_started], NULL, worker_main, &job) != 0) break;
+    }
+    if (n_started == 0) {
+        fprintf(stderr, "Warning: Could not start transcoding threads, converting on this thread.\n");
+        worker_main(&job);
+    }
+    for (size_t i = 0; i < n_started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    if (asciivideo_writer_close(job.writer) != 0 && !job.failed) {
+        fprintf(stderr, "Error: Failed to write the video file!\n");
+        job.failed = 1;
+    }
+    if (stats) {
+        stats->n_frames = (size_t) job.next_write;
+        stats->n_workers = n_started > 0 ? n_started : 1;
+        stats->window = window;
+        stats->seconds = now_seconds() - start;
+    }
+
+    for (size_t i = 0; i < window; i++) {
+        free_ascii_grid(&job.slots[i].grid);
+    }
+    pthread_mutex_destroy(&job.mutex);
+    pthread_cond_destroy(&job.progress);
+    free(job.slots);
+    free(threads);
+    return job.failed ? -1 : 0;
+}
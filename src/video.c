@@ -0,0 +1,358 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "../include/video.h"
+#include "../include/threadpool.h"
+#include "../include/cpu_dispatch.h"
+
+#define N_BUFFERS 3             // Being filled, newest complete, held by the consumer
+#define MAX_HEADER_LENGTH 1024
+#define ROWS_PER_TASK 16
+// Largest frame side accepted, as for images; frames must also fit RGB24 in memory
+#define MAX_DIMENSION ((size_t) 1 << 24)
+
+struct video_reader {
+    video_stream_t stream;
+
+    uint8_t* buffers[N_BUFFERS];
+    double arrival[N_BUFFERS];
+    uint64_t sequence[N_BUFFERS];
+    int latest;                 // Newest complete frame not taken yet, -1 if none
+    int held;                   // Frame held by the consumer, -1 if none
+
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t arrived;
+    int eof;
+    int stop;
+    uint64_t n_read;
+    uint64_t n_dropped;
+};
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Reads exactly `length` bytes. Returns 0 on success, -1 at end of stream or on error.
+static int read_full(int fd, uint8_t* data, size_t length) {
+    size_t offset = 0;
+    while (offset < length) {
+        ssize_t n = read(fd, data + offset, length - offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        offset += (size_t) n;
+    }
+    return 0;
+}
+
+// Reads one '\n'-terminated line (without it). Headers are short: byte reads are fine.
+static int read_line(int fd, char* line, size_t capacity) {
+    size_t length = 0;
+    for (;;) {
+        char c;
+        ssize_t n = read(fd, &c, 1);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        if (c == '\n') break;
+        if (length + 1 < capacity) line[length++] = c;
+    }
+    line[length] = '\0';
+    return 0;
+}
+
+// "YUV4MPEG2 W640 H480 F30000:1001 Ip A1:1 C420jpeg ..."
+static int parse_y4m_header(video_stream_t* stream, const char* header) {
+    if (strncmp(header, "YUV4MPEG2", 9) != 0) return -1;
+
+    stream->chroma = VIDEO_CHROMA_420;
+    const char* p = header + 9;
+    while (*p) {
+        while (*p == ' ') p++;
+        if (!*p) break;
+        char tag = *p++;
+        if (tag == 'W') stream->width = strtoul(p, NULL, 10);
+        else if (tag == 'H') stream->height = strtoul(p, NULL, 10);
+        else if (tag == 'F') {
+            unsigned long num = 0, den = 0;
+            if (sscanf(p, "%lu:%lu", &num, &den) == 2 && num > 0 && den > 0) {
+                stream->fps_num = (uint32_t) num;
+                stream->fps_den = (uint32_t) den;
+            }
+        } else if (tag == 'C') {
+            // Whole token: only 8-bit layouts (420p10, 444p16, mono16... are rejected)
+            size_t length = strcspn(p, " ");
+            if (length == 3 && strncmp(p, "444", 3) == 0) stream->chroma = VIDEO_CHROMA_444;
+            else if (length == 4 && strncmp(p, "mono", 4) == 0) stream->chroma = VIDEO_CHROMA_MONO;
+            else if (!((length == 3 && strncmp(p, "420", 3) == 0) ||
+                       (length == 7 && strncmp(p, "420jpeg", 7) == 0) ||
+                       (length == 8 && strncmp(p, "420paldv", 8) == 0) ||
+                       (length == 8 && strncmp(p, "420mpeg2", 8) == 0))) {
+                fprintf(stderr, "Error: Unsupported Y4M color space 'C%.*s'!\n", (int) (length < 16 ? length : 16), p);
+                return -1;
+            }
+        }
+        while (*p && *p != ' ') p++;
+    }
+    return (stream->width > 0 && stream->height > 0) ? 0 : -1;
+}
+
+// --- Streams ---
+
+// Whether a width x height frame is within limits: 3 bytes per pixel (RGB24, or
+// Y4M 4:4:4 at most) must not overflow size_t
+static int valid_frame_size(size_t width, size_t height) {
+    return width > 0 && height > 0 && width <= MAX_DIMENSION && height <= MAX_DIMENSION &&
+           height <= SIZE_MAX / 3 / width;
+}
+
+int video_stream_open(video_stream_t* stream, int fd, size_t width, size_t height) {
+    *stream = (video_stream_t) {0};
+    stream->fd = fd;
+
+    if (width > 0 && height > 0) {
+        if (!valid_frame_size(width, height)) {
+            fprintf(stderr, "Error: Video frames of %zux%zu are too large!\n", width, height);
+            return -1;
+        }
+        stream->format = VIDEO_RAW_RGB24;
+        stream->width = width;
+        stream->height = height;
+        stream->frame_bytes = width * height * 3;
+        return 0;
+    }
+
+    char header[MAX_HEADER_LENGTH];
+    stream->format = VIDEO_Y4M;
+    if (read_line(fd, header, sizeof(header)) != 0 || parse_y4m_header(stream, header) != 0) {
+        fprintf(stderr, "Error: Input is not a Y4M stream (use --video WxH for raw RGB24)!\n");
+        return -1;
+    }
+    if (!valid_frame_size(stream->width, stream->height)) {
+        fprintf(stderr, "Error: Video frames of %zux%zu are too large!\n", stream->width, stream->height);
+        return -1;
+    }
+    size_t luma = stream->width * stream->height;
+    size_t chroma = ((stream->width + 1) / 2) * ((stream->height + 1) / 2);
+    if (stream->chroma == VIDEO_CHROMA_444) chroma = luma;
+    if (stream->chroma == VIDEO_CHROMA_MONO) chroma = 0;
+    stream->frame_bytes = luma + 2 * chroma;
+    return 0;
+}
+
+int video_stream_read(video_stream_t* stream, uint8_t* frame) {
+    if (stream->format == VIDEO_Y4M) {
+        char line[MAX_HEADER_LENGTH];
+        if (read_line(stream->fd, line, sizeof(line)) != 0 || strncmp(line, "FRAME", 5) != 0) return -1;
+    }
+    return read_full(stream->fd, frame, stream->frame_bytes);
+}
+
+double video_stream_fps(const video_stream_t* stream) {
+    return stream->fps_den > 0 ? (double) stream->fps_num / stream->fps_den : 0.0;
+}
+
+static void* reader_main(void* data) {
+    video_reader_t* reader = data;
+    uint64_t sequence = 0;
+
+    for (;;) {
+        // A buffer that is neither the newest frame nor held by the consumer
+        pthread_mutex_lock(&reader->mutex);
+        int target = 0;
+        while (target == reader->latest || target == reader->held) target++;
+        int stop = reader->stop;
+        pthread_mutex_unlock(&reader->mutex);
+        if (stop) break;
+
+        if (video_stream_read(&reader->stream, reader->buffers[target]) != 0) break;
+
+        pthread_mutex_lock(&reader->mutex);
+        if (reader->latest >= 0) reader->n_dropped++; // Never taken: superseded
+        reader->latest = target;
+        reader->arrival[target] = now_seconds();
+        reader->sequence[target] = sequence++;
+        reader->n_read++;
+        pthread_cond_signal(&reader->arrived);
+        pthread_mutex_unlock(&reader->mutex);
+    }
+
+    pthread_mutex_lock(&reader->mutex);
+    reader->eof = 1;
+    pthread_cond_signal(&reader->arrived);
+    pthread_mutex_unlock(&reader->mutex);
+    return NULL;
+}
+
+video_reader_t* video_reader_open(int fd, size_t width, size_t height) {
+    video_reader_t* reader = calloc(1, sizeof(*reader));
+    if (!reader) {
+        fprintf(stderr, "Error: Failed to allocate memory for video reader!\n");
+        return NULL;
+    }
+    reader->latest = reader->held = -1;
+    if (video_stream_open(&reader->stream, fd, width, height) != 0) {
+        free(reader);
+        return NULL;
+    }
+
+    for (int i = 0; i < N_BUFFERS; i++) {
+        reader->buffers[i] = malloc(reader->stream.frame_bytes);
+        if (!reader->buffers[i]) {
+            fprintf(stderr, "Error: Failed to allocate memory for video frames!\n");
+            for (int j = 0; j < i; j++) free(reader->buffers[j]);
+            free(reader);
+            return NULL;
+        }
+    }
+
+    pthread_mutex_init(&reader->mutex, NULL);
+    pthread_cond_init(&reader->arrived, NULL);
+    if (pthread_create(&reader->thread, NULL, reader_main, reader) != 0) {
+        fprintf(stderr, "Error: Failed to start the video reader thread!\n");
+        pthread_mutex_destroy(&reader->mutex);
+        pthread_cond_destroy(&reader->arrived);
+        for (int i = 0; i < N_BUFFERS; i++) free(reader->buffers[i]);
+        free(reader);
+        return NULL;
+    }
+    return reader;
+}
+
+void video_reader_close(video_reader_t* reader) {
+    if (!reader) return;
+
+    // The thread may be blocked in read(): it is detached rather than joined
+    // unless the stream already ended
+    pthread_mutex_lock(&reader->mutex);
+    reader->stop = 1;
+    int eof = reader->eof;
+    pthread_mutex_unlock(&reader->mutex);
+    if (!eof) {
+        pthread_detach(reader->thread);
+        return; // Buffers stay with the thread until the process exits
+    }
+    pthread_join(reader->thread, NULL);
+
+    pthread_mutex_destroy(&reader->mutex);
+    pthread_cond_destroy(&reader->arrived);
+    for (int i = 0; i < N_BUFFERS; i++) free(reader->buffers[i]);
+    free(reader);
+}
+
+const video_stream_t* video_reader_stream(const video_reader_t* reader) {
+    return &reader->stream;
+}
+
+int video_reader_next(video_reader_t* reader, video_frame_t* frame) {
+    pthread_mutex_lock(&reader->mutex);
+    reader->held = -1; // The previous frame goes back to the pool
+    while (reader->latest < 0 && !reader->eof) {
+        pthread_cond_wait(&reader->arrived, &reader->mutex);
+    }
+    int index = reader->latest;
+    if (index >= 0) {
+        reader->held = index;
+        reader->latest = -1;
+        frame->data = reader->buffers[index];
+        frame->arrival = reader->arrival[index];
+        frame->sequence = reader->sequence[index];
+    }
+    pthread_mutex_unlock(&reader->mutex);
+    return (index >= 0) ? 0 : -1;
+}
+
+void video_reader_counts(video_reader_t* reader, uint64_t* n_read, uint64_t* n_dropped) {
+    pthread_mutex_lock(&reader->mutex);
+    *n_read = reader->n_read;
+    *n_dropped = reader->n_dropped;
+    pthread_mutex_unlock(&reader->mutex);
+}
+
+// --- YUV to RGB ---
+
+typedef struct {
+    const video_stream_t* stream;
+    const uint8_t* frame;
+    uint8_t* rgb;
+} convert_job_t;
+
+static uint8_t clamp_u8(int value) {
+    return (uint8_t) (value < 0 ? 0 : value > 255 ? 255 : value);
+}
+
+// BT.601, limited range (what Y4M producers write by default), 16.16 fixed point
+HOT_KERNEL
+static void yuv_rows(void* arg, size_t row_begin, size_t row_end) {
+    convert_job_t* job = arg;
+    const video_stream_t* stream = job->stream;
+    size_t width = stream->width, height = stream->height;
+    size_t chroma_w = (stream->chroma == VIDEO_CHROMA_444) ? width : (width + 1) / 2;
+    size_t chroma_h = (stream->chroma == VIDEO_CHROMA_444) ? height : (height + 1) / 2;
+    const uint8_t* y_plane = job->frame;
+    const uint8_t* u_plane = y_plane + width * height;
+    const uint8_t* v_plane = u_plane + chroma_w * chroma_h;
+    int shift = (stream->chroma == VIDEO_CHROMA_444) ? 0 : 1;
+
+    for (size_t y = row_begin; y < row_end; y++) {
+        uint8_t* out = &job->rgb[y * width * 3];
+        for (size_t x = 0; x < width; x++, out += 3) {
+            int luma = 76309 * (y_plane[y * width + x] - 16);
+            if (stream->chroma == VIDEO_CHROMA_MONO) {
+                out[0] = out[1] = out[2] = clamp_u8((luma + 32768) >> 16);
+                continue;
+            }
+            size_t c = (y >> shift) * chroma_w + (x >> shift);
+            int u = u_plane[c] - 128, v = v_plane[c] - 128;
+            out[0] = clamp_u8((luma + 104597 * v + 32768) >> 16);
+            out[1] = clamp_u8((luma - 25675 * u - 53279 * v + 32768) >> 16);
+            out[2] = clamp_u8((luma + 132201 * u + 32768) >> 16);
+        }
+    }
+}
+
+const uint8_t* video_stream_to_rgb(const video_stream_t* stream, const uint8_t* frame, uint8_t* rgb) {
+    if (stream->format == VIDEO_RAW_RGB24) return frame;
+
+    convert_job_t job = {stream, frame, rgb};
+    parallel_for(stream->height, ROWS_PER_TASK, yuv_rows, &job);
+    return rgb;
+}
+
+// --- Latency Statistics ---
+
+void latency_stats_add(latency_stats_t* stats, double seconds) {
+    size_t bucket = (size_t) (seconds * 1000.0);
+    if (bucket > LATENCY_BUCKETS) bucket = LATENCY_BUCKETS;
+    stats->buckets[bucket]++;
+    stats->count++;
+    stats->sum += seconds;
+    if (seconds > stats->max) stats->max = seconds;
+}
+
+// Upper edge (ms) of the bucket holding the given fraction of the samples
+static double percentile_ms(const latency_stats_t* stats, double fraction) {
+    uint64_t rank = (uint64_t) (fraction * stats->count);
+    uint64_t seen = 0;
+    for (size_t i = 0; i <= LATENCY_BUCKETS; i++) {
+        seen += stats->buckets[i];
+        if (seen > rank) return (double) (i + 1);
+    }
+    return stats->max * 1000.0;
+}
+
+void latency_stats_print(const latency_stats_t* stats, const char* label, FILE* out) {
+    if (stats->count == 0) {
+        fprintf(out, "%s: no frames\n", label);
+        return;
+    }
+    fprintf(out, "%s: %llu frames, mean %.1f ms, p50 <%.0f ms, p95 <%.0f ms, p99 <%.0f ms, max %.1f ms\n",
+            label, (unsigned long long) stats->count, 1000.0 * stats->sum / stats->count,
+            percentile_ms(stats, 0.50), percentile_ms(stats, 0.95), percentile_ms(stats, 0.99), 1000.0 * stats->max);
+}
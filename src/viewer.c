@@ -0,0 +1,280 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <termios.h>
+
+#include "../include/viewer.h"
+#include "../include/argparse.h"
+#include "../include/pyramid.h"
+#include "../include/video.h"
+
+#define ZOOM_STEP 1.5
+// Share of the view moved by one pan key
+#define PAN_FRACTION 0.25
+// Terminal cells are about twice as tall as wide (the converter's character ratio)
+#define CELL_ASPECT 2.0
+#define KEY_BUFFER_SIZE 64
+// Wait for the rest of an arrow key sequence split across reads before taking Esc alone
+#define ESCAPE_TIMEOUT_MS 50
+
+#define ENTER_SCREEN "\033[?1049h\033[?25l"
+#define LEAVE_SCREEN "\033[?25h\033[?1049l"
+#define ERASE_LINE "\033[K"
+#define MOVE_TO_ROW "\033[%zu;1H"
+
+typedef struct {
+    double x, y;    // Center, in pixels of the original
+    double zoom;    // Original pixels per cell column
+} viewport_t;
+
+typedef struct {
+    asciiview_ctx_t* ctx;
+    image_t* original;
+    mip_pyramid_t pyramid;
+    export_options_t options;   // As given; the width is set for each view
+    size_t samples_x, samples_y;
+    size_t cols, rows;          // Terminal cells available to the image
+    viewport_t view;
+    image_t crop;               // View cut out of a pyramid level
+    size_t crop_capacity;       // In doubles
+    double* crop_buffer;
+} viewer_t;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void update_terminal_size(viewer_t* viewer) {
+    int width = 80, height = 24;
+    try_get_terminal_size(&width, &height);
+    viewer->cols = width > 1 ? (size_t) width : 1;
+    viewer->rows = height > 2 ? (size_t) height - 1 : 1; // Last line: status
+}
+
+// Closest zoom that still gives every sample a pixel of the original
+static double min_zoom(const viewer_t* viewer) {
+    return fmax((double) viewer->samples_x, viewer->samples_y / CELL_ASPECT);
+}
+
+// Zoom showing the whole image
+static double fit_zoom(const viewer_t* viewer) {
+    double zoom = fmax((double) viewer->original->width / viewer->cols,
+                       viewer->original->height / (viewer->rows * CELL_ASPECT));
+    return fmax(zoom, min_zoom(viewer));
+}
+
+static void fit_view(viewer_t* viewer) {
+    viewer->view.zoom = fit_zoom(viewer);
+    viewer->view.x = viewer->original->width / 2.0;
+    viewer->view.y = viewer->original->height / 2.0;
+}
+
+// Size of the view in pixels of the original, within the image
+static void view_size(const viewer_t* viewer, double* width, double* height) {
+    *width = fmin((double) viewer->original->width, viewer->cols * viewer->view.zoom);
+    *height = fmin((double) viewer->original->height, viewer->rows * viewer->view.zoom * CELL_ASPECT);
+}
+
+static void clamp_view(viewer_t* viewer) {
+    viewport_t* view = &viewer->view;
+    view->zoom = fmin(fmax(view->zoom, min_zoom(viewer)), fit_zoom(viewer));
+    double width, height;
+    view_size(viewer, &width, &height);
+    view->x = fmin(fmax(view->x, width / 2.0), viewer->original->width - width / 2.0);
+    view->y = fmin(fmax(view->y, height / 2.0), viewer->original->height - height / 2.0);
+}
+
+// Cuts the view out of `source` (`scale` original pixels per pixel). Full-width
+// views are used in place; others are copied into the crop buffer.
+static int cut_view(viewer_t* viewer, image_t* source, double scale) {
+    double width, height;
+    view_size(viewer, &width, &height);
+    size_t w = (size_t) (width / scale + 0.5), h = (size_t) (height / scale + 0.5);
+    if (w < 1) w = 1;
+    if (h < 1) h = 1;
+    if (w > source->width) w = source->width;
+    if (h > source->height) h = source->height;
+    size_t x0 = (size_t) fmax(0.0, (viewer->view.x - width / 2.0) / scale);
+    size_t y0 = (size_t) fmax(0.0, (viewer->view.y - height / 2.0) / scale);
+    if (x0 > source->width - w) x0 = source->width - w;
+    if (y0 > source->height - h) y0 = source->height - h;
+
+    size_t channels = source->channels;
+    viewer->crop = (image_t) {w, h, channels, NULL};
+    if (w == source->width) {
+        viewer->crop.data = source->data + y0 * w * channels;
+        return 0;
+    }
+
+    if (w * h * channels > viewer->crop_capacity) {
+        double* buffer = realloc(viewer->crop_buffer, w * h * channels * sizeof(*buffer));
+        if (!buffer) {
+            fprintf(stderr, "Error: Failed to allocate memory for the view!\n");
+            return -1;
+        }
+        viewer->crop_buffer = buffer;
+        viewer->crop_capacity = w * h * channels;
+    }
+    for (size_t y = 0; y < h; y++) {
+        memcpy(&viewer->crop_buffer[y * w * channels], &source->data[((y0 + y) * source->width + x0) * channels],
+               w * channels * sizeof(double));
+    }
+    viewer->crop.data = viewer->crop_buffer;
+    return 0;
+}
+
+// Converts the current view and redraws the cells that changed. With `wait`, the
+// pyramid level suited to the view is awaited; otherwise the best one built so far serves.
+static int render_view(viewer_t* viewer, int wait) {
+    update_terminal_size(viewer);
+    clamp_view(viewer);
+
+    // Coarsest level that still has a pixel for every sample
+    double zoom = viewer->view.zoom;
+    double per_sample = fmin(zoom / viewer->samples_x, zoom * CELL_ASPECT / viewer->samples_y);
+    size_t max_level = 0;
+    while (ldexp(1.0, (int) max_level + 1) <= per_sample) max_level++;
+    if (wait) pyramid_wait(&viewer->pyramid, max_level);
+    size_t level;
+    image_t* source = pyramid_level(&viewer->pyramid, max_level, &level);
+    if (cut_view(viewer, source, ldexp(1.0, (int) level)) != 0) return -1;
+
+    double width, height;
+    view_size(viewer, &width, &height);
+    export_options_t options = viewer->options;
+    options.width_chars = (int) fmax(1.0, floor(width / zoom));
+    ascii_grid_t grid = asciiview_convert(viewer->ctx, &viewer->crop, &options);
+    if (!grid.chars) {
+        fprintf(stderr, "Error: Failed to process the view.\n");
+        return -1;
+    }
+    asciiview_redraw(viewer->ctx, &options);
+
+    printf(MOVE_TO_ROW "%.1f px/cell, level %zu of %zu | +/- zoom, arrows pan, f fit, q quit" ERASE_LINE,
+           viewer->rows + 1, zoom, level, viewer->pyramid.n_levels - 1);
+    fflush(stdout);
+    return 0;
+}
+
+typedef enum { KEY_NONE, KEY_QUIT, KEY_VIEW } key_action_t;
+
+// Whether `keys` stops inside an arrow key sequence (after ESC or ESC [)
+static int ends_in_escape(const char* keys, size_t length) {
+    if (length >= 1 && keys[length - 1] == '\033') return 1;
+    return length >= 2 && keys[length - 2] == '\033' && keys[length - 1] == '[';
+}
+
+// Applies the keys in `keys`; returns whether to quit or redraw
+static key_action_t apply_keys(viewer_t* viewer, const char* keys, size_t length) {
+    key_action_t action = KEY_NONE;
+    double width, height;
+    view_size(viewer, &width, &height);
+    viewport_t* view = &viewer->view;
+
+    for (size_t i = 0; i < length; i++) {
+        char key = keys[i];
+        if (key == '\033') {
+            // Arrow keys arrive as ESC [ A..D; a lone Esc quits
+            if (i + 2 >= length || keys[i + 1] != '[') return KEY_QUIT;
+            key = keys[i + 2];
+            i += 2;
+            if (key == 'A') key = 'k';
+            else if (key == 'B') key = 'j';
+            else if (key == 'C') key = 'l';
+            else if (key == 'D') key = 'h';
+        }
+
+        switch (key) {
+            case 'q': case 'Q': case 3: case 4: // Ctrl-C and Ctrl-D too (signals are off)
+                return KEY_QUIT;
+            case '+': case '=':
+                view->zoom /= ZOOM_STEP;
+                break;
+            case '-': case '_':
+                view->zoom *= ZOOM_STEP;
+                break;
+            case 'f': case '0':
+                fit_view(viewer);
+                break;
+            case 'h': view->x -= width * PAN_FRACTION; break;
+            case 'l': view->x += width * PAN_FRACTION; break;
+            case 'k': view->y -= height * PAN_FRACTION; break;
+            case 'j': view->y += height * PAN_FRACTION; break;
+            default:
+                continue;
+        }
+        action = KEY_VIEW;
+        clamp_view(viewer);
+        view_size(viewer, &width, &height);
+    }
+    return action;
+}
+
+int run_viewer(asciiview_ctx_t* ctx, image_t* original, const export_options_t* options) {
+    if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO)) {
+        fprintf(stderr, "Error: Interactive mode needs a terminal.\n");
+        return 1;
+    }
+
+    viewer_t viewer = {0};
+    viewer.ctx = ctx;
+    viewer.original = original;
+    viewer.options = *options;
+    viewer.options.scale_factor = 0;
+    viewer.options.target_pixel_w = viewer.options.target_pixel_h = 0;
+    viewer.samples_x = (options->glyph_mode == GLYPH_MODE_BRAILLE) ? 2 : 1;
+    viewer.samples_y = (options->glyph_mode == GLYPH_MODE_BRAILLE) ? 4 : (options->glyph_mode == GLYPH_MODE_HALF) ? 2 : 1;
+    pyramid_start(&viewer.pyramid, original);
+
+    struct termios saved, raw;
+    if (tcgetattr(STDIN_FILENO, &saved) != 0) {
+        fprintf(stderr, "Error: Could not configure the terminal.\n");
+        pyramid_free(&viewer.pyramid);
+        return 1;
+    }
+    raw = saved;
+    raw.c_lflag &= ~(tcflag_t) (ICANON | ECHO | ISIG);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+    printf(ENTER_SCREEN);
+
+    update_terminal_size(&viewer);
+    fit_view(&viewer);
+    latency_stats_t latency = {0};
+    // The first frame waits for its level: on a large image, building the
+    // pyramid costs about as much as converting the full-resolution view
+    int status = render_view(&viewer, 1) == 0 ? 0 : 1;
+    while (status == 0) {
+        char keys[KEY_BUFFER_SIZE];
+        ssize_t length = read(STDIN_FILENO, keys, sizeof(keys));
+        if (length <= 0) break;
+        double pressed = now_seconds();
+        while (ends_in_escape(keys, (size_t) length) && (size_t) length < sizeof(keys)) {
+            struct pollfd poll_fd = {STDIN_FILENO, POLLIN, 0};
+            if (poll(&poll_fd, 1, ESCAPE_TIMEOUT_MS) <= 0) break;
+            ssize_t more = read(STDIN_FILENO, keys + length, sizeof(keys) - (size_t) length);
+            if (more <= 0) break;
+            length += more;
+        }
+        key_action_t action = apply_keys(&viewer, keys, (size_t) length);
+        if (action == KEY_QUIT) break;
+        if (action == KEY_NONE) continue;
+        if (render_view(&viewer, 0) != 0) status = 1;
+        latency_stats_add(&latency, now_seconds() - pressed);
+    }
+
+    printf(LEAVE_SCREEN);
+    fflush(stdout);
+    tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+    pyramid_free(&viewer.pyramid);
+    free(viewer.crop_buffer);
+    latency_stats_print(&latency, "Keypress to frame", stderr);
+    return status;
+}